@@ -0,0 +1,100 @@
+#pragma once
+
+#include "Camera.hpp"
+#include "RenderStats.hpp"
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+
+// Scenes main() can load, by name. The benchmark orbits the camera around
+// the origin at orbitRadius.
+struct SceneDescription
+{
+    std::string_view name;
+    const char* modelPath;
+    float scale;
+    float orbitRadius;
+};
+
+const SceneDescription* findScene(std::string_view name);
+
+// Command line of the executable:
+//   --scene <name>      scene to load (globe, backpack)
+//   --benchmark         render offscreen and exit after the scripted run
+//   --frames <count>    measured frames of the benchmark
+//   --warmup <count>    frames rendered before measuring
+//   --size <w>x<h>      size of the offscreen target
+//   --output <path>     JSON result file (benchmark.json)
+//   --trace <path>      record a profiler trace and write it on exit
+struct CommandLine
+{
+    std::string scene = "globe";
+    bool benchmark = false;
+    uint32_t frames = 600;
+    uint32_t warmupFrames = 60;
+    uint32_t width = 1280;
+    uint32_t height = 720;
+    std::string output = "benchmark.json";
+    std::string trace;
+};
+
+std::optional<CommandLine> parseCommandLine(int argc, char** argv);
+
+// Camera of a frame of the scripted benchmark path: one full orbit around the
+// origin over frameCount frames, bobbing up and down twice, always looking at
+// the origin. Only depends on the frame index, so runs are reproducible.
+Camera getBenchmarkCamera(uint32_t frame, uint32_t frameCount, float orbitRadius);
+
+// Framebuffer with RGBA8 color and 24-bit depth renderbuffers, used as the
+// render target when there is nothing to present to.
+class OffscreenTarget
+{
+public:
+    static std::optional<OffscreenTarget> create(uint32_t width, uint32_t height);
+
+    ~OffscreenTarget();
+
+    OffscreenTarget(const OffscreenTarget&) = delete;
+    OffscreenTarget& operator=(const OffscreenTarget&) = delete;
+
+    OffscreenTarget(OffscreenTarget&& other) noexcept;
+    OffscreenTarget& operator=(OffscreenTarget&& other) noexcept;
+
+    void bind() const;
+
+private:
+    OffscreenTarget() = default;
+
+    uint32_t m_framebuffer = 0;
+    uint32_t m_color = 0;
+    uint32_t m_depth = 0;
+    uint32_t m_width = 0;
+    uint32_t m_height = 0;
+};
+
+// Per-frame measurements of a benchmark run. cpuTime covers the frame from
+// the start of the update to the last submitted draw; frameTime additionally
+// waits for the GPU with glFinish. GL call counts are only known, and only
+// written, in GL_INSTRUMENTATION builds.
+class BenchmarkRecorder
+{
+public:
+    void addFrame(double cpuTime, double frameTime, const RenderStats::Counters& counters, uint64_t glCalls);
+
+    bool write(const CommandLine& commandLine, std::string_view renderer, std::string_view version) const;
+
+private:
+    struct Frame
+    {
+        double cpuTime;
+        double frameTime;
+        RenderStats::Counters counters;
+        uint64_t glCalls;
+    };
+
+    std::vector<Frame> m_frames;
+};
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <limits>
+
+
+struct Vertex;
+
+struct Ray
+{
+    glm::vec3 origin;
+    glm::vec3 direction;
+
+    Ray transformed(const glm::mat4& transform) const;
+};
+
+struct AABB
+{
+    glm::vec3 min = glm::vec3(std::numeric_limits<float>::max());
+    glm::vec3 max = glm::vec3(std::numeric_limits<float>::lowest());
+
+    static AABB fromVertices(std::span<const Vertex> vertices);
+
+    bool isEmpty() const;
+    glm::vec3 getCenter() const;
+    glm::vec3 getExtents() const;
+
+    void expand(const glm::vec3& point);
+    void expand(const AABB& other);
+
+    AABB transformed(const glm::mat4& transform) const;
+
+    bool intersects(const Ray& ray, const glm::vec3& inverseDirection, float maxDistance, float& distance) const;
+};
+
+struct BoundingSphere
+{
+    glm::vec3 center = glm::vec3(0.0f);
+    float radius = 0.0f;
+
+    static BoundingSphere fromVertices(std::span<const Vertex> vertices, const AABB& bounds);
+};
\ No newline at end of file
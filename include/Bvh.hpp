@@ -0,0 +1,56 @@
+#pragma once
+
+#include "Bounds.hpp"
+#include "Frustum.hpp"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <optional>
+#include <functional>
+
+
+// Bounding volume hierarchy over a list of item AABBs, built with a binned
+// surface area heuristic and flattened into one array of 32-byte nodes. The
+// two children of an inner node are stored next to each other, and always
+// after their parent, so refit() is a single reverse sweep.
+class Bvh
+{
+public:
+    struct RayHit
+    {
+        uint32_t item;
+        float distance;
+    };
+
+    // Returns the hit distance along the ray if the item is hit closer than
+    // the given maximum.
+    using ItemIntersector = std::function<std::optional<float>(uint32_t item, const Ray& ray, float maxDistance)>;
+
+    static Bvh build(std::span<const AABB> bounds);
+
+    void refit(std::span<const AABB> bounds);
+
+    void queryFrustum(const Frustum& frustum, std::vector<uint32_t>& items) const;
+    std::optional<RayHit> queryRay(const Ray& ray, float maxDistance, const ItemIntersector& intersect) const;
+
+    size_t getNodeCount() const;
+
+private:
+    struct Node
+    {
+        glm::vec3 min;
+        uint32_t leftOrFirst;
+        glm::vec3 max;
+        uint32_t count;
+
+        bool isLeaf() const { return count > 0; }
+    };
+
+    static_assert(sizeof(Node) == 32);
+
+    void subdivide(uint32_t nodeIdx, uint32_t depth, std::span<const AABB> bounds, std::span<const glm::vec3> centroids);
+
+    std::vector<Node> m_nodes;
+    std::vector<uint32_t> m_items;
+};
\ No newline at end of file
@@ -39,7 +39,9 @@ public:
     glm::mat4 getViewMatrix() const;
 
     float getZoom() const;
+    float getProjectionScale(float viewportHeight) const;
     const glm::vec3& getPosition() const;
+    const glm::vec3& getFront() const;
 
     void processKeyboard(Movement direction, float deltaTime);
     void processKeyboard(Looking direction, float deltaTime);
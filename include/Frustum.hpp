@@ -0,0 +1,40 @@
+#pragma once
+
+#include "Bounds.hpp"
+
+#include <glm/glm.hpp>
+
+#include <span>
+#include <cstdint>
+
+
+struct CullStats
+{
+    uint32_t tested = 0;
+    uint32_t visible = 0;
+};
+
+// View frustum extracted from a clip matrix (Gribb/Hartmann). Passing
+// projection * view * model yields the frustum in that model's local space,
+// so local bounds can be tested without transforming them.
+//
+// The six planes are kept as structure-of-arrays padded to eight lanes so the
+// per-sphere loop over planes vectorizes.
+class Frustum
+{
+public:
+    static Frustum fromMatrix(const glm::mat4& clip);
+
+    bool intersects(const BoundingSphere& sphere) const;
+    bool intersects(const AABB& bounds) const;
+
+    CullStats cull(std::span<const BoundingSphere> spheres, std::span<const AABB> bounds, std::span<uint8_t> visible) const;
+
+private:
+    static constexpr size_t LANES = 8;
+
+    alignas(32) float m_x[LANES];
+    alignas(32) float m_y[LANES];
+    alignas(32) float m_z[LANES];
+    alignas(32) float m_w[LANES];
+};
\ No newline at end of file
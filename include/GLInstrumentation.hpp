@@ -0,0 +1,454 @@
+#pragma once
+
+#include <GL/glew.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+
+// Optional GL call instrumentation, built with -DGL_INSTRUMENTATION=ON.
+//
+// The option force-includes this header into every translation unit of the
+// renderer. It replaces the GL entry points the renderer uses with counting
+// wrappers. Binds and uniform uploads also remember the last value per binding
+// point or uniform location, so calls that change nothing are counted as
+// redundant. endFrame() closes a frame and report() logs the calls with the
+// most calls and the most redundant calls per frame.
+//
+// Without the option only the empty endFrame()/report() below remain and the
+// entry points are the plain GLEW ones. Must only be used from the GL thread.
+#ifdef GL_INSTRUMENTATION
+
+class GLInstrumentation
+{
+public:
+    static constexpr bool ENABLED = true;
+
+    static void count(std::string_view call);
+
+    static void useProgram(GLuint program);
+    static void bindVertexArray(GLuint vertexArray);
+    static void bindBuffer(GLenum target, GLuint buffer);
+    static void bindBufferRange(std::string_view call, GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size);
+    static void activeTexture(GLenum unit);
+    static void bindTexture(GLenum target, GLuint texture);
+    static void bindFramebuffer(GLenum target, GLuint framebuffer);
+    static void bindRenderbuffer(GLenum target, GLuint renderbuffer);
+    static void uniform(std::string_view call, GLint location, const void* data, size_t size);
+
+    // Deleted or relinked objects may come back under the same name, so the
+    // remembered state that could refer to them is dropped.
+    static void forget(std::string_view call);
+    static void forgetProgram(std::string_view call, GLuint program);
+
+    static void endFrame();
+    static void report(size_t topCount = 10);
+
+    // Calls made in the frame closed by the last endFrame().
+    static uint64_t getLastFrameCalls();
+};
+
+namespace GLInstrumented
+{
+    template<typename Function>
+    const Function& counted(std::string_view call, const Function& function)
+    {
+        GLInstrumentation::count(call);
+        return function;
+    }
+}
+
+// Captures the GLEW entry point before its name is redefined below.
+#define GL_INSTRUMENTATION_ORIGINAL(function) \
+    namespace GLInstrumented { inline constexpr auto original_##function = [](auto... args) { return function(args...); }; }
+
+GL_INSTRUMENTATION_ORIGINAL(glUseProgram)
+GL_INSTRUMENTATION_ORIGINAL(glBindVertexArray)
+GL_INSTRUMENTATION_ORIGINAL(glBindBuffer)
+GL_INSTRUMENTATION_ORIGINAL(glBindBufferBase)
+GL_INSTRUMENTATION_ORIGINAL(glBindBufferRange)
+GL_INSTRUMENTATION_ORIGINAL(glActiveTexture)
+GL_INSTRUMENTATION_ORIGINAL(glBindTexture)
+GL_INSTRUMENTATION_ORIGINAL(glBindFramebuffer)
+GL_INSTRUMENTATION_ORIGINAL(glBindRenderbuffer)
+GL_INSTRUMENTATION_ORIGINAL(glUniform1i)
+GL_INSTRUMENTATION_ORIGINAL(glUniform1f)
+GL_INSTRUMENTATION_ORIGINAL(glUniform3fv)
+GL_INSTRUMENTATION_ORIGINAL(glUniformMatrix4fv)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteBuffers)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteTextures)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteVertexArrays)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteFramebuffers)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteRenderbuffers)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteProgram)
+GL_INSTRUMENTATION_ORIGINAL(glLinkProgram)
+
+// Entry points that are only counted.
+GL_INSTRUMENTATION_ORIGINAL(glAttachShader)
+GL_INSTRUMENTATION_ORIGINAL(glBufferData)
+GL_INSTRUMENTATION_ORIGINAL(glBufferStorage)
+GL_INSTRUMENTATION_ORIGINAL(glBufferSubData)
+GL_INSTRUMENTATION_ORIGINAL(glCheckFramebufferStatus)
+GL_INSTRUMENTATION_ORIGINAL(glClear)
+GL_INSTRUMENTATION_ORIGINAL(glClearColor)
+GL_INSTRUMENTATION_ORIGINAL(glClientWaitSync)
+GL_INSTRUMENTATION_ORIGINAL(glCompileShader)
+GL_INSTRUMENTATION_ORIGINAL(glCompressedTexImage2D)
+GL_INSTRUMENTATION_ORIGINAL(glCompressedTexSubImage2D)
+GL_INSTRUMENTATION_ORIGINAL(glCopyBufferSubData)
+GL_INSTRUMENTATION_ORIGINAL(glCreateProgram)
+GL_INSTRUMENTATION_ORIGINAL(glCreateShader)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteShader)
+GL_INSTRUMENTATION_ORIGINAL(glDeleteSync)
+GL_INSTRUMENTATION_ORIGINAL(glDisableVertexAttribArray)
+GL_INSTRUMENTATION_ORIGINAL(glDrawElementsBaseVertex)
+GL_INSTRUMENTATION_ORIGINAL(glDrawElementsInstancedBaseVertex)
+GL_INSTRUMENTATION_ORIGINAL(glEnable)
+GL_INSTRUMENTATION_ORIGINAL(glEnableVertexAttribArray)
+GL_INSTRUMENTATION_ORIGINAL(glFenceSync)
+GL_INSTRUMENTATION_ORIGINAL(glFinish)
+GL_INSTRUMENTATION_ORIGINAL(glFramebufferRenderbuffer)
+GL_INSTRUMENTATION_ORIGINAL(glGenBuffers)
+GL_INSTRUMENTATION_ORIGINAL(glGenFramebuffers)
+GL_INSTRUMENTATION_ORIGINAL(glGenQueries)
+GL_INSTRUMENTATION_ORIGINAL(glGenRenderbuffers)
+GL_INSTRUMENTATION_ORIGINAL(glGenTextures)
+GL_INSTRUMENTATION_ORIGINAL(glGenVertexArrays)
+GL_INSTRUMENTATION_ORIGINAL(glGetActiveUniform)
+GL_INSTRUMENTATION_ORIGINAL(glGetInteger64v)
+GL_INSTRUMENTATION_ORIGINAL(glGetIntegerv)
+GL_INSTRUMENTATION_ORIGINAL(glGetProgramBinary)
+GL_INSTRUMENTATION_ORIGINAL(glGetProgramInfoLog)
+GL_INSTRUMENTATION_ORIGINAL(glGetProgramiv)
+GL_INSTRUMENTATION_ORIGINAL(glGetQueryObjectui64v)
+GL_INSTRUMENTATION_ORIGINAL(glGetQueryObjectuiv)
+GL_INSTRUMENTATION_ORIGINAL(glGetShaderInfoLog)
+GL_INSTRUMENTATION_ORIGINAL(glGetShaderiv)
+GL_INSTRUMENTATION_ORIGINAL(glGetString)
+GL_INSTRUMENTATION_ORIGINAL(glGetUniformBlockIndex)
+GL_INSTRUMENTATION_ORIGINAL(glGetUniformLocation)
+GL_INSTRUMENTATION_ORIGINAL(glMapBufferRange)
+GL_INSTRUMENTATION_ORIGINAL(glMultiDrawElementsIndirect)
+GL_INSTRUMENTATION_ORIGINAL(glPixelStorei)
+GL_INSTRUMENTATION_ORIGINAL(glPolygonMode)
+GL_INSTRUMENTATION_ORIGINAL(glProgramBinary)
+GL_INSTRUMENTATION_ORIGINAL(glProgramParameteri)
+GL_INSTRUMENTATION_ORIGINAL(glQueryCounter)
+GL_INSTRUMENTATION_ORIGINAL(glRenderbufferStorage)
+GL_INSTRUMENTATION_ORIGINAL(glShaderSource)
+GL_INSTRUMENTATION_ORIGINAL(glTexImage2D)
+GL_INSTRUMENTATION_ORIGINAL(glTexParameteri)
+GL_INSTRUMENTATION_ORIGINAL(glTexStorage2D)
+GL_INSTRUMENTATION_ORIGINAL(glTexSubImage2D)
+GL_INSTRUMENTATION_ORIGINAL(glUniformBlockBinding)
+GL_INSTRUMENTATION_ORIGINAL(glUnmapBuffer)
+GL_INSTRUMENTATION_ORIGINAL(glVertexAttrib4f)
+GL_INSTRUMENTATION_ORIGINAL(glVertexAttribDivisor)
+GL_INSTRUMENTATION_ORIGINAL(glVertexAttribPointer)
+GL_INSTRUMENTATION_ORIGINAL(glViewport)
+
+namespace GLInstrumented
+{
+    inline void useProgram(GLuint program)
+    {
+        GLInstrumentation::useProgram(program);
+        original_glUseProgram(program);
+    }
+
+    inline void bindVertexArray(GLuint vertexArray)
+    {
+        GLInstrumentation::bindVertexArray(vertexArray);
+        original_glBindVertexArray(vertexArray);
+    }
+
+    inline void bindBuffer(GLenum target, GLuint buffer)
+    {
+        GLInstrumentation::bindBuffer(target, buffer);
+        original_glBindBuffer(target, buffer);
+    }
+
+    inline void bindBufferBase(GLenum target, GLuint index, GLuint buffer)
+    {
+        GLInstrumentation::bindBufferRange("glBindBufferBase", target, index, buffer, 0, 0);
+        original_glBindBufferBase(target, index, buffer);
+    }
+
+    inline void bindBufferRange(GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+    {
+        GLInstrumentation::bindBufferRange("glBindBufferRange", target, index, buffer, offset, size);
+        original_glBindBufferRange(target, index, buffer, offset, size);
+    }
+
+    inline void activeTexture(GLenum unit)
+    {
+        GLInstrumentation::activeTexture(unit);
+        original_glActiveTexture(unit);
+    }
+
+    inline void bindTexture(GLenum target, GLuint texture)
+    {
+        GLInstrumentation::bindTexture(target, texture);
+        original_glBindTexture(target, texture);
+    }
+
+    inline void bindFramebuffer(GLenum target, GLuint framebuffer)
+    {
+        GLInstrumentation::bindFramebuffer(target, framebuffer);
+        original_glBindFramebuffer(target, framebuffer);
+    }
+
+    inline void bindRenderbuffer(GLenum target, GLuint renderbuffer)
+    {
+        GLInstrumentation::bindRenderbuffer(target, renderbuffer);
+        original_glBindRenderbuffer(target, renderbuffer);
+    }
+
+    inline void uniform1i(GLint location, GLint value)
+    {
+        GLInstrumentation::uniform("glUniform1i", location, &value, sizeof(value));
+        original_glUniform1i(location, value);
+    }
+
+    inline void uniform1f(GLint location, GLfloat value)
+    {
+        GLInstrumentation::uniform("glUniform1f", location, &value, sizeof(value));
+        original_glUniform1f(location, value);
+    }
+
+    inline void uniform3fv(GLint location, GLsizei count, const GLfloat* value)
+    {
+        GLInstrumentation::uniform("glUniform3fv", location, value, 3 * count * sizeof(GLfloat));
+        original_glUniform3fv(location, count, value);
+    }
+
+    inline void uniformMatrix4fv(GLint location, GLsizei count, GLboolean transpose, const GLfloat* value)
+    {
+        GLInstrumentation::uniform("glUniformMatrix4fv", location, value, 16 * count * sizeof(GLfloat));
+        original_glUniformMatrix4fv(location, count, transpose, value);
+    }
+
+    inline void deleteBuffers(GLsizei count, const GLuint* buffers)
+    {
+        GLInstrumentation::forget("glDeleteBuffers");
+        original_glDeleteBuffers(count, buffers);
+    }
+
+    inline void deleteTextures(GLsizei count, const GLuint* textures)
+    {
+        GLInstrumentation::forget("glDeleteTextures");
+        original_glDeleteTextures(count, textures);
+    }
+
+    inline void deleteVertexArrays(GLsizei count, const GLuint* vertexArrays)
+    {
+        GLInstrumentation::forget("glDeleteVertexArrays");
+        original_glDeleteVertexArrays(count, vertexArrays);
+    }
+
+    inline void deleteFramebuffers(GLsizei count, const GLuint* framebuffers)
+    {
+        GLInstrumentation::forget("glDeleteFramebuffers");
+        original_glDeleteFramebuffers(count, framebuffers);
+    }
+
+    inline void deleteRenderbuffers(GLsizei count, const GLuint* renderbuffers)
+    {
+        GLInstrumentation::forget("glDeleteRenderbuffers");
+        original_glDeleteRenderbuffers(count, renderbuffers);
+    }
+
+    inline void deleteProgram(GLuint program)
+    {
+        GLInstrumentation::forgetProgram("glDeleteProgram", program);
+        original_glDeleteProgram(program);
+    }
+
+    inline void linkProgram(GLuint program)
+    {
+        GLInstrumentation::forgetProgram("glLinkProgram", program);
+        original_glLinkProgram(program);
+    }
+}
+
+#undef glUseProgram
+#undef glBindVertexArray
+#undef glBindBuffer
+#undef glBindBufferBase
+#undef glBindBufferRange
+#undef glActiveTexture
+#undef glBindTexture
+#undef glBindFramebuffer
+#undef glBindRenderbuffer
+#undef glUniform1i
+#undef glUniform1f
+#undef glUniform3fv
+#undef glUniformMatrix4fv
+#undef glDeleteBuffers
+#undef glDeleteTextures
+#undef glDeleteVertexArrays
+#undef glDeleteFramebuffers
+#undef glDeleteRenderbuffers
+#undef glDeleteProgram
+#undef glLinkProgram
+
+#define glUseProgram GLInstrumented::useProgram
+#define glBindVertexArray GLInstrumented::bindVertexArray
+#define glBindBuffer GLInstrumented::bindBuffer
+#define glBindBufferBase GLInstrumented::bindBufferBase
+#define glBindBufferRange GLInstrumented::bindBufferRange
+#define glActiveTexture GLInstrumented::activeTexture
+#define glBindTexture GLInstrumented::bindTexture
+#define glBindFramebuffer GLInstrumented::bindFramebuffer
+#define glBindRenderbuffer GLInstrumented::bindRenderbuffer
+#define glUniform1i GLInstrumented::uniform1i
+#define glUniform1f GLInstrumented::uniform1f
+#define glUniform3fv GLInstrumented::uniform3fv
+#define glUniformMatrix4fv GLInstrumented::uniformMatrix4fv
+#define glDeleteBuffers GLInstrumented::deleteBuffers
+#define glDeleteTextures GLInstrumented::deleteTextures
+#define glDeleteVertexArrays GLInstrumented::deleteVertexArrays
+#define glDeleteFramebuffers GLInstrumented::deleteFramebuffers
+#define glDeleteRenderbuffers GLInstrumented::deleteRenderbuffers
+#define glDeleteProgram GLInstrumented::deleteProgram
+#define glLinkProgram GLInstrumented::linkProgram
+
+#undef glAttachShader
+#undef glBufferData
+#undef glBufferStorage
+#undef glBufferSubData
+#undef glCheckFramebufferStatus
+#undef glClear
+#undef glClearColor
+#undef glClientWaitSync
+#undef glCompileShader
+#undef glCompressedTexImage2D
+#undef glCompressedTexSubImage2D
+#undef glCopyBufferSubData
+#undef glCreateProgram
+#undef glCreateShader
+#undef glDeleteShader
+#undef glDeleteSync
+#undef glDisableVertexAttribArray
+#undef glDrawElementsBaseVertex
+#undef glDrawElementsInstancedBaseVertex
+#undef glEnable
+#undef glEnableVertexAttribArray
+#undef glFenceSync
+#undef glFinish
+#undef glFramebufferRenderbuffer
+#undef glGenBuffers
+#undef glGenFramebuffers
+#undef glGenQueries
+#undef glGenRenderbuffers
+#undef glGenTextures
+#undef glGenVertexArrays
+#undef glGetActiveUniform
+#undef glGetInteger64v
+#undef glGetIntegerv
+#undef glGetProgramBinary
+#undef glGetProgramInfoLog
+#undef glGetProgramiv
+#undef glGetQueryObjectui64v
+#undef glGetQueryObjectuiv
+#undef glGetShaderInfoLog
+#undef glGetShaderiv
+#undef glGetString
+#undef glGetUniformBlockIndex
+#undef glGetUniformLocation
+#undef glMapBufferRange
+#undef glMultiDrawElementsIndirect
+#undef glPixelStorei
+#undef glPolygonMode
+#undef glProgramBinary
+#undef glProgramParameteri
+#undef glQueryCounter
+#undef glRenderbufferStorage
+#undef glShaderSource
+#undef glTexImage2D
+#undef glTexParameteri
+#undef glTexStorage2D
+#undef glTexSubImage2D
+#undef glUniformBlockBinding
+#undef glUnmapBuffer
+#undef glVertexAttrib4f
+#undef glVertexAttribDivisor
+#undef glVertexAttribPointer
+#undef glViewport
+
+#define glAttachShader GLInstrumented::counted("glAttachShader", GLInstrumented::original_glAttachShader)
+#define glBufferData GLInstrumented::counted("glBufferData", GLInstrumented::original_glBufferData)
+#define glBufferStorage GLInstrumented::counted("glBufferStorage", GLInstrumented::original_glBufferStorage)
+#define glBufferSubData GLInstrumented::counted("glBufferSubData", GLInstrumented::original_glBufferSubData)
+#define glCheckFramebufferStatus GLInstrumented::counted("glCheckFramebufferStatus", GLInstrumented::original_glCheckFramebufferStatus)
+#define glClear GLInstrumented::counted("glClear", GLInstrumented::original_glClear)
+#define glClearColor GLInstrumented::counted("glClearColor", GLInstrumented::original_glClearColor)
+#define glClientWaitSync GLInstrumented::counted("glClientWaitSync", GLInstrumented::original_glClientWaitSync)
+#define glCompileShader GLInstrumented::counted("glCompileShader", GLInstrumented::original_glCompileShader)
+#define glCompressedTexImage2D GLInstrumented::counted("glCompressedTexImage2D", GLInstrumented::original_glCompressedTexImage2D)
+#define glCompressedTexSubImage2D GLInstrumented::counted("glCompressedTexSubImage2D", GLInstrumented::original_glCompressedTexSubImage2D)
+#define glCopyBufferSubData GLInstrumented::counted("glCopyBufferSubData", GLInstrumented::original_glCopyBufferSubData)
+#define glCreateProgram GLInstrumented::counted("glCreateProgram", GLInstrumented::original_glCreateProgram)
+#define glCreateShader GLInstrumented::counted("glCreateShader", GLInstrumented::original_glCreateShader)
+#define glDeleteShader GLInstrumented::counted("glDeleteShader", GLInstrumented::original_glDeleteShader)
+#define glDeleteSync GLInstrumented::counted("glDeleteSync", GLInstrumented::original_glDeleteSync)
+#define glDisableVertexAttribArray GLInstrumented::counted("glDisableVertexAttribArray", GLInstrumented::original_glDisableVertexAttribArray)
+#define glDrawElementsBaseVertex GLInstrumented::counted("glDrawElementsBaseVertex", GLInstrumented::original_glDrawElementsBaseVertex)
+#define glDrawElementsInstancedBaseVertex GLInstrumented::counted("glDrawElementsInstancedBaseVertex", GLInstrumented::original_glDrawElementsInstancedBaseVertex)
+#define glEnable GLInstrumented::counted("glEnable", GLInstrumented::original_glEnable)
+#define glEnableVertexAttribArray GLInstrumented::counted("glEnableVertexAttribArray", GLInstrumented::original_glEnableVertexAttribArray)
+#define glFenceSync GLInstrumented::counted("glFenceSync", GLInstrumented::original_glFenceSync)
+#define glFinish GLInstrumented::counted("glFinish", GLInstrumented::original_glFinish)
+#define glFramebufferRenderbuffer GLInstrumented::counted("glFramebufferRenderbuffer", GLInstrumented::original_glFramebufferRenderbuffer)
+#define glGenBuffers GLInstrumented::counted("glGenBuffers", GLInstrumented::original_glGenBuffers)
+#define glGenFramebuffers GLInstrumented::counted("glGenFramebuffers", GLInstrumented::original_glGenFramebuffers)
+#define glGenQueries GLInstrumented::counted("glGenQueries", GLInstrumented::original_glGenQueries)
+#define glGenRenderbuffers GLInstrumented::counted("glGenRenderbuffers", GLInstrumented::original_glGenRenderbuffers)
+#define glGenTextures GLInstrumented::counted("glGenTextures", GLInstrumented::original_glGenTextures)
+#define glGenVertexArrays GLInstrumented::counted("glGenVertexArrays", GLInstrumented::original_glGenVertexArrays)
+#define glGetActiveUniform GLInstrumented::counted("glGetActiveUniform", GLInstrumented::original_glGetActiveUniform)
+#define glGetInteger64v GLInstrumented::counted("glGetInteger64v", GLInstrumented::original_glGetInteger64v)
+#define glGetIntegerv GLInstrumented::counted("glGetIntegerv", GLInstrumented::original_glGetIntegerv)
+#define glGetProgramBinary GLInstrumented::counted("glGetProgramBinary", GLInstrumented::original_glGetProgramBinary)
+#define glGetProgramInfoLog GLInstrumented::counted("glGetProgramInfoLog", GLInstrumented::original_glGetProgramInfoLog)
+#define glGetProgramiv GLInstrumented::counted("glGetProgramiv", GLInstrumented::original_glGetProgramiv)
+#define glGetQueryObjectui64v GLInstrumented::counted("glGetQueryObjectui64v", GLInstrumented::original_glGetQueryObjectui64v)
+#define glGetQueryObjectuiv GLInstrumented::counted("glGetQueryObjectuiv", GLInstrumented::original_glGetQueryObjectuiv)
+#define glGetShaderInfoLog GLInstrumented::counted("glGetShaderInfoLog", GLInstrumented::original_glGetShaderInfoLog)
+#define glGetShaderiv GLInstrumented::counted("glGetShaderiv", GLInstrumented::original_glGetShaderiv)
+#define glGetString GLInstrumented::counted("glGetString", GLInstrumented::original_glGetString)
+#define glGetUniformBlockIndex GLInstrumented::counted("glGetUniformBlockIndex", GLInstrumented::original_glGetUniformBlockIndex)
+#define glGetUniformLocation GLInstrumented::counted("glGetUniformLocation", GLInstrumented::original_glGetUniformLocation)
+#define glMapBufferRange GLInstrumented::counted("glMapBufferRange", GLInstrumented::original_glMapBufferRange)
+#define glMultiDrawElementsIndirect GLInstrumented::counted("glMultiDrawElementsIndirect", GLInstrumented::original_glMultiDrawElementsIndirect)
+#define glPixelStorei GLInstrumented::counted("glPixelStorei", GLInstrumented::original_glPixelStorei)
+#define glPolygonMode GLInstrumented::counted("glPolygonMode", GLInstrumented::original_glPolygonMode)
+#define glProgramBinary GLInstrumented::counted("glProgramBinary", GLInstrumented::original_glProgramBinary)
+#define glProgramParameteri GLInstrumented::counted("glProgramParameteri", GLInstrumented::original_glProgramParameteri)
+#define glQueryCounter GLInstrumented::counted("glQueryCounter", GLInstrumented::original_glQueryCounter)
+#define glRenderbufferStorage GLInstrumented::counted("glRenderbufferStorage", GLInstrumented::original_glRenderbufferStorage)
+#define glShaderSource GLInstrumented::counted("glShaderSource", GLInstrumented::original_glShaderSource)
+#define glTexImage2D GLInstrumented::counted("glTexImage2D", GLInstrumented::original_glTexImage2D)
+#define glTexParameteri GLInstrumented::counted("glTexParameteri", GLInstrumented::original_glTexParameteri)
+#define glTexStorage2D GLInstrumented::counted("glTexStorage2D", GLInstrumented::original_glTexStorage2D)
+#define glTexSubImage2D GLInstrumented::counted("glTexSubImage2D", GLInstrumented::original_glTexSubImage2D)
+#define glUniformBlockBinding GLInstrumented::counted("glUniformBlockBinding", GLInstrumented::original_glUniformBlockBinding)
+#define glUnmapBuffer GLInstrumented::counted("glUnmapBuffer", GLInstrumented::original_glUnmapBuffer)
+#define glVertexAttrib4f GLInstrumented::counted("glVertexAttrib4f", GLInstrumented::original_glVertexAttrib4f)
+#define glVertexAttribDivisor GLInstrumented::counted("glVertexAttribDivisor", GLInstrumented::original_glVertexAttribDivisor)
+#define glVertexAttribPointer GLInstrumented::counted("glVertexAttribPointer", GLInstrumented::original_glVertexAttribPointer)
+#define glViewport GLInstrumented::counted("glViewport", GLInstrumented::original_glViewport)
+
+#else
+
+class GLInstrumentation
+{
+public:
+    static constexpr bool ENABLED = false;
+
+    static void endFrame() {}
+    static void report(size_t topCount = 10) { static_cast<void>(topCount); }
+    static uint64_t getLastFrameCalls() { return 0; }
+};
+
+#endif
\ No newline at end of file
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+
+// Shadow copy of the GL binding state of the current context. Binds that
+// would not change anything are skipped instead of reaching the driver.
+//
+// Anything that binds programs, vertex arrays, textures or uniform buffer
+// ranges must go through here, and deleted objects must be forgotten so a
+// reused name is rebound.
+class GLState
+{
+public:
+    static constexpr size_t TEXTURE_UNITS = 16;
+    static constexpr size_t UNIFORM_BINDINGS = 8;
+
+    static void useProgram(uint32_t program);
+    static void bindVertexArray(uint32_t vertexArray);
+    static void bindTexture(uint32_t unit, uint32_t texture);
+    static void bindUniformBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t size);
+
+    static void forgetProgram(uint32_t program);
+    static void forgetVertexArray(uint32_t vertexArray);
+    static void forgetTexture(uint32_t texture);
+    static void forgetUniformBuffer(uint32_t buffer);
+
+    static void invalidate();
+
+private:
+    struct UniformRange
+    {
+        uint32_t buffer = 0;
+        size_t offset = 0;
+        size_t size = 0;
+    };
+
+    struct State
+    {
+        uint32_t program = 0;
+        uint32_t vertexArray = 0;
+        uint32_t activeUnit = 0;
+        std::array<uint32_t, TEXTURE_UNITS> textures {};
+        std::array<UniformRange, UNIFORM_BINDINGS> uniformBuffers {};
+    };
+
+    static State s_state;
+};
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+
+#include "VertexFormat.hpp"
+
+#include <span>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+
+// One vertex buffer, one index buffer and one VAO that many meshes
+// suballocate from. A mesh is then just a range inside the arena and is
+// drawn with glDrawElementsBaseVertex, so every mesh of a model shares the
+// same bound VAO. The buffers grow (and are copied on the GPU) when an
+// allocation does not fit.
+//
+// An arena stores either full Vertex data or PackedVertex data quantized to
+// one box for the whole arena; float vertices given to a packed arena are
+// packed on upload.
+class GeometryArena
+{
+public:
+    struct Range
+    {
+        int32_t baseVertex = 0;
+        uint32_t firstIndex = 0;
+        uint32_t indexCount = 0;
+    };
+
+    static std::shared_ptr<GeometryArena> create(size_t vertexCapacity, size_t indexCapacity, VertexFormat format = VertexFormat::Float, const VertexQuantization& quantization = {});
+    ~GeometryArena();
+
+    GeometryArena(const GeometryArena&) = delete;
+    GeometryArena& operator=(const GeometryArena&) = delete;
+
+    Range allocate(std::span<const Vertex> vertices, std::span<const uint32_t> indices);
+    Range allocate(std::span<const PackedVertex> vertices, std::span<const uint32_t> indices);
+
+    VertexFormat getFormat() const;
+    const VertexQuantization& getQuantization() const;
+
+    uint32_t getVertexArray() const;
+    uint32_t getVertexBuffer() const;
+    uint32_t getElementBuffer() const;
+
+    void setupVertexAttributes() const;
+
+private:
+    GeometryArena() = default;
+
+    Range reserve(size_t vertexCount, std::span<const uint32_t> indices);
+    void writeVertices(const Range& range, const void* vertices, size_t size);
+    void reallocate(size_t vertexCapacity, size_t indexCapacity);
+
+    VertexFormat m_format = VertexFormat::Float;
+    VertexQuantization m_quantization;
+
+    uint32_t m_vertexArray = 0;
+    uint32_t m_vertexBuffer = 0;
+    uint32_t m_elementBuffer = 0;
+
+    size_t m_vertexCapacity = 0;
+    size_t m_vertexCount = 0;
+    size_t m_indexCapacity = 0;
+    size_t m_indexCount = 0;
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ull;
+constexpr uint64_t FNV_PRIME = 1099511628211ull;
+
+inline uint64_t fnv1a(const void* data, size_t size, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+
+    for (size_t idx = 0; idx < size; ++idx)
+    {
+        hash ^= bytes[idx];
+        hash *= FNV_PRIME;
+    }
+
+    return hash;
+}
+
+inline uint64_t fnv1a(std::string_view text, uint64_t hash = FNV_OFFSET_BASIS)
+{
+    return fnv1a(text.data(), text.size(), hash);
+}
\ No newline at end of file
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "Shader.hpp"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+
+
+struct DrawElementsIndirectCommand
+{
+    uint32_t count;
+    uint32_t instanceCount;
+    uint32_t firstIndex;
+    int32_t baseVertex;
+    uint32_t baseInstance;
+};
+
+// Draws a list of arena-backed meshes with one glMultiDrawElementsIndirect
+// per run of meshes that share a VAO and texture set. The commands live in
+// a GL_DRAW_INDIRECT_BUFFER that is only re-uploaded when they change.
+// lods, when given, holds the LOD to draw for every mesh index.
+// Needs GL 4.3 or ARB_multi_draw_indirect.
+class IndirectDrawBuffer
+{
+public:
+    static bool isSupported();
+    static IndirectDrawBuffer create();
+
+    ~IndirectDrawBuffer();
+
+    IndirectDrawBuffer(const IndirectDrawBuffer&) = delete;
+    IndirectDrawBuffer& operator=(const IndirectDrawBuffer&) = delete;
+
+    IndirectDrawBuffer(IndirectDrawBuffer&& other) noexcept;
+    IndirectDrawBuffer& operator=(IndirectDrawBuffer&& other) noexcept;
+
+    void draw(const Shader& shader, const std::vector<Mesh>& meshes, std::span<const uint32_t> order, std::span<const uint32_t> lods = {});
+
+private:
+    struct Bucket
+    {
+        uint32_t mesh;
+        uint32_t firstCommand;
+        uint32_t commandCount;
+    };
+
+    IndirectDrawBuffer() = default;
+
+    void upload();
+
+    uint32_t m_buffer = 0;
+    size_t m_capacity = 0;
+
+    std::vector<DrawElementsIndirectCommand> m_commands;
+    std::vector<DrawElementsIndirectCommand> m_uploaded;
+    std::vector<Bucket> m_buckets;
+};
\ No newline at end of file
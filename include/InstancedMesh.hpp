@@ -0,0 +1,49 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "Shader.hpp"
+
+#include <glm/glm.hpp>
+
+#include <span>
+
+
+// Draws one Mesh many times with a single glDrawElementsInstanced call.
+//
+// Per-instance transforms (and optional colors) are streamed into an
+// instance buffer bound as divisor-1 attributes 3-6 (model matrix columns)
+// and 7 (color) of a VAO that shares the mesh's arena buffers. The mesh must
+// outlive the InstancedMesh. Use with the *Instanced shader variants.
+class InstancedMesh
+{
+public:
+    static constexpr uint32_t TRANSFORM_ATTRIBUTE = 3;
+    static constexpr uint32_t COLOR_ATTRIBUTE = 7;
+
+    static InstancedMesh create(const Mesh& mesh);
+    ~InstancedMesh();
+
+    InstancedMesh(const InstancedMesh&) = delete;
+    InstancedMesh& operator=(const InstancedMesh&) = delete;
+
+    InstancedMesh(InstancedMesh&& other) noexcept;
+    InstancedMesh& operator=(InstancedMesh&& other) noexcept;
+
+    void draw(const Shader& shader, std::span<const glm::mat4> transforms, std::span<const glm::vec4> colors = {});
+
+private:
+    InstancedMesh() = default;
+
+    void setupVertexArray();
+
+    const Mesh* m_mesh = nullptr;
+
+    uint32_t m_vertexArray = 0;
+    uint32_t m_arenaBuffer = 0;
+
+    uint32_t m_transformBuffer = 0;
+    size_t m_transformCapacity = 0;
+
+    uint32_t m_colorBuffer = 0;
+    size_t m_colorCapacity = 0;
+};
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <optional>
+#include <string_view>
+
+
+// Block-compressed formats understood by the KTX2 reader and writer, as their
+// VkFormat values (the KTX2 container identifies formats that way).
+enum class CompressedFormat : uint32_t
+{
+    Bc1 = 131,
+    Bc1Srgb = 132,
+    Bc1Alpha = 133,
+    Bc1AlphaSrgb = 134,
+    Bc3 = 137,
+    Bc3Srgb = 138,
+    Bc5 = 141,
+    Bc7 = 145,
+    Bc7Srgb = 146,
+    Etc2 = 147,
+    Etc2Srgb = 148,
+    Etc2Alpha = 151,
+    Etc2AlphaSrgb = 152
+};
+
+// A 2D block-compressed image with its complete mip chain, as stored in a KTX2
+// file. Level 0 is the full-size image; every level points into data.
+struct Ktx2Image
+{
+    struct Level
+    {
+        size_t offset;
+        size_t size;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    CompressedFormat format;
+    uint32_t width;
+    uint32_t height;
+    // Rows stored bottom-up (KTXorientation "ru"), i.e. already flipped for GL.
+    bool flippedVertically;
+    std::vector<Level> levels;
+    std::vector<uint8_t> data;
+};
+
+// Bytes per 4x4 block, or 0 for values that are not a known format.
+size_t getBlockSize(CompressedFormat format);
+size_t getCompressedSize(CompressedFormat format, uint32_t width, uint32_t height);
+
+// Only plain 2D images without supercompression are accepted.
+std::optional<Ktx2Image> readKtx2(std::string_view path);
+bool writeKtx2(std::string_view path, const Ktx2Image& image);
\ No newline at end of file
@@ -1,11 +1,189 @@
 #pragma once
 
+#include <array>
+#include <atomic>
+#include <chrono>
 #include <format>
-#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <cstdint>
+#include <string_view>
 
 
+enum class LogLevel : uint8_t
+{
+    Debug,
+    Info,
+    Warning,
+    Error
+};
+
+// Messages below this level are compiled out. Release builds define
+// LOG_MIN_LEVEL=1, which removes debug messages.
+#ifndef LOG_MIN_LEVEL
+#define LOG_MIN_LEVEL 0
+#endif
+
+constexpr LogLevel MIN_LOG_LEVEL = static_cast<LogLevel>(LOG_MIN_LEVEL);
+
+struct LogRecord
+{
+    static constexpr size_t TEXT_SIZE = 496;
+
+    std::atomic<size_t> sequence;
+    LogLevel level;
+    uint32_t suppressed;
+    uint32_t length;
+    std::array<char, TEXT_SIZE> text;
+};
+
+// Asynchronous logger writing to stdout.
+//
+// Messages are formatted on the calling thread straight into a record of a
+// preallocated ring, which a background thread drains and writes, so logging
+// never allocates or blocks on I/O. The ring is a bounded lock-free
+// multi-producer queue; when it is full the message is dropped and counted
+// instead of waiting. Errors, and every message once setBlocking(true) has
+// been called (the offline tools do), wait for a free record instead. Longer
+// messages are truncated to the record size.
+//
+// Call sites that may fire every frame use logLimited(): such a site,
+// identified by its format string, may log RATE_LIMIT_BURST messages per
+// RATE_LIMIT_WINDOW and the rest are counted and reported with its next
+// message. Errors and the plain log functions are never limited. The writer
+// also collapses consecutive identical lines.
+class Logger
+{
+public:
+    static constexpr size_t QUEUE_CAPACITY = 1024;
+    static constexpr size_t SITE_COUNT = 512;
+    static constexpr size_t SITE_PROBES = 8;
+    static constexpr uint32_t RATE_LIMIT_BURST = 10;
+    static constexpr std::chrono::milliseconds RATE_LIMIT_WINDOW { 1000 };
+
+    static_assert((QUEUE_CAPACITY & (QUEUE_CAPACITY - 1)) == 0, "Queue capacity must be a power of two");
+
+    // Returns nullptr once the logger has been destroyed at exit.
+    static Logger* get();
+
+    ~Logger();
+
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    // Claims a record for a message of the given call site. Returns nullptr
+    // when the queue is full, or when limited is set and the site is over
+    // its rate.
+    LogRecord* acquire(LogLevel level, std::string_view format, bool limited);
+
+    // Hands a claimed record to the writer. size is the untruncated length of
+    // the formatted text.
+    void publish(LogRecord& record, size_t size);
+
+    // In blocking mode every message waits for a free record instead of being
+    // dropped when the queue is full. Meant for batch tools, whose output is
+    // their report; the renderer keeps it off so logging never stalls a frame.
+    void setBlocking(bool blocking);
+
+    // Synchronous fallback for messages logged after shutdown.
+    static void writeDirect(LogLevel level, std::string_view text);
+
+private:
+    struct Site
+    {
+        std::atomic<const char*> format = nullptr;
+        std::atomic<size_t> formatSize = 0;
+        std::atomic<int64_t> windowStart = 0;
+        std::atomic<uint32_t> count = 0;
+        std::atomic<uint32_t> suppressed = 0;
+    };
+
+    Logger();
+
+    Site* findSite(std::string_view format);
+    bool limitRate(std::string_view format, uint32_t& suppressed);
+
+    void run();
+    bool drain();
+    void write(LogLevel level, std::string_view text, uint32_t suppressed);
+    void writeRepeats();
+    void writeSuppressed();
+
+    static std::atomic<bool> s_destroyed;
+
+    const std::chrono::steady_clock::time_point m_epoch;
+
+    std::unique_ptr<LogRecord[]> m_records;
+    alignas(64) std::atomic<size_t> m_enqueuePosition = 0;
+    alignas(64) std::atomic<uint32_t> m_signal = 0;
+    std::atomic<size_t> m_dropped = 0;
+    std::atomic<bool> m_stopping = false;
+    std::atomic<bool> m_blocking = false;
+
+    std::array<Site, SITE_COUNT> m_sites;
+
+    // Owned by the writer thread.
+    size_t m_dequeuePosition = 0;
+    size_t m_reportedDrops = 0;
+    LogLevel m_lastLevel = LogLevel::Debug;
+    std::string m_lastText;
+    uint32_t m_repeats = 0;
+
+    std::thread m_thread;
+};
+
+template <LogLevel level, bool limited, typename... TArgs>
+void logMessage(std::format_string<TArgs...> fmt, TArgs&&... args)
+{
+    if constexpr (level >= MIN_LOG_LEVEL)
+    {
+        Logger* logger = Logger::get();
+
+        if (logger == nullptr)
+        {
+            Logger::writeDirect(level, std::format(fmt, std::forward<TArgs>(args)...));
+            return;
+        }
+
+        LogRecord* record = logger->acquire(level, fmt.get(), limited);
+
+        if (record == nullptr)
+        {
+            return;
+        }
+
+        const auto result = std::format_to_n(record->text.data(), record->text.size(), fmt, std::forward<TArgs>(args)...);
+        logger->publish(*record, static_cast<size_t>(result.size));
+    }
+}
+
 template <typename... TArgs>
-void log(std::format_string<TArgs...> fmt, TArgs&&... args)
+void logDebug(std::format_string<TArgs...> fmt, TArgs&&... args)
+{
+    logMessage<LogLevel::Debug, false>(fmt, std::forward<TArgs>(args)...);
+}
+
+template <typename... TArgs>
+void logInfo(std::format_string<TArgs...> fmt, TArgs&&... args)
+{
+    logMessage<LogLevel::Info, false>(fmt, std::forward<TArgs>(args)...);
+}
+
+template <typename... TArgs>
+void logWarning(std::format_string<TArgs...> fmt, TArgs&&... args)
+{
+    logMessage<LogLevel::Warning, false>(fmt, std::forward<TArgs>(args)...);
+}
+
+template <typename... TArgs>
+void logError(std::format_string<TArgs...> fmt, TArgs&&... args)
+{
+    logMessage<LogLevel::Error, false>(fmt, std::forward<TArgs>(args)...);
+}
+
+template <LogLevel level, typename... TArgs>
+void logLimited(std::format_string<TArgs...> fmt, TArgs&&... args)
 {
-    std::puts(std::format(fmt, std::forward<TArgs>(args)...).c_str());
+    logMessage<level, level != LogLevel::Error>(fmt, std::forward<TArgs>(args)...);
 }
\ No newline at end of file
@@ -1,19 +1,38 @@
 #pragma once
 
+#include "Ktx2.hpp"
+#include "Bounds.hpp"
+#include "MipChain.hpp"
 #include "Shader.hpp"
+#include "VertexFormat.hpp"
+#include "GeometryArena.hpp"
 
 #include <glm/glm.hpp>
 
+#include <span>
+#include <memory>
 #include <string>
 #include <vector>
 #include <optional>
 
 
-struct Vertex
+// A GL texture object shared by every Texture that refers to it. The GL
+// texture is deleted together with the last reference.
+//
+// Uploads replace the GL object (immutable storage cannot be resized), so the
+// id may change over the resource's lifetime; always read it at bind time.
+struct TextureResource
 {
-    glm::vec3 position;
-    glm::vec3 normal;
-    glm::vec2 texCoords;
+    uint32_t id = 0;
+    size_t bytes = 0;
+    // Finest mip level of the source image held by the GL texture; its level 0.
+    uint32_t residentLevel = 0;
+
+    explicit TextureResource(uint32_t id, size_t bytes = 0);
+    ~TextureResource();
+
+    TextureResource(const TextureResource&) = delete;
+    TextureResource& operator=(const TextureResource&) = delete;
 };
 
 struct Texture
@@ -26,17 +45,65 @@ struct Texture
         Height
     };
 
-    uint32_t id;
+    std::shared_ptr<TextureResource> resource;
     Type type;
     std::string file;
 
+    uint32_t getId() const;
+
+    // Prefers a pre-compressed "<name>.ktx2" next to the image when the GL
+    // context can sample its format.
     static std::optional<Texture> load(const std::string& file, const std::string& directory, Type type);
+
+    static uint32_t createPlaceholder();
+    // Both replace the texture's GL object; upload() skips the levels finer
+    // than firstLevel.
+    static void upload(TextureResource& texture, const MipChain& mips, uint32_t firstLevel = 0);
+    static void uploadCompressed(TextureResource& texture, const Ktx2Image& image, uint32_t internalFormat);
+
+    static std::string getCompressedPath(std::string_view path);
+    // GL internal format for a compressed format, or 0 when the context cannot
+    // sample it.
+    static uint32_t getCompressedFormat(CompressedFormat format);
+
+    // GPU memory of an uploaded image including its mip chain.
+    static size_t getMemorySize(const MipChain& mips, uint32_t firstLevel = 0);
+    static size_t getMemorySize(const Ktx2Image& image);
+};
+
+// A level of detail: a slice of the mesh's index buffer and the object-space
+// error the simplifier introduced to produce it.
+struct MeshLod
+{
+    uint32_t firstIndex;
+    uint32_t indexCount;
+    float error;
+};
+
+struct MeshData
+{
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    std::vector<Texture> textures;
+    std::vector<MeshLod> lods;
+};
+
+struct MeshHit
+{
+    uint32_t triangle;
+    float distance;
 };
 
 class Mesh
 {
 public:
-    static Mesh create(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Texture>& textures);
+    // With keepGeometry false only the GPU copy of the vertices and indices
+    // survives; bounds, LOD ranges and counts are still kept, but intersect()
+    // finds nothing.
+    static Mesh create(std::span<const Vertex> vertices, std::span<const uint32_t> indices, const std::vector<Texture>& textures, std::span<const MeshLod> lods = {}, bool keepGeometry = true);
+    static Mesh create(const std::shared_ptr<GeometryArena>& arena, std::span<const Vertex> vertices, std::span<const uint32_t> indices, const std::vector<Texture>& textures, std::span<const MeshLod> lods = {}, bool keepGeometry = true);
+    static Mesh create(const std::shared_ptr<GeometryArena>& arena, std::span<const PackedVertex> vertices, std::span<const uint32_t> indices, const std::vector<Texture>& textures, std::span<const MeshLod> lods = {}, bool keepGeometry = true);
+    static Mesh create(const std::shared_ptr<GeometryArena>& arena, MeshData&& data, bool keepGeometry = true);
     ~Mesh();
 
     Mesh(const Mesh&) = delete;
@@ -45,16 +112,48 @@ public:
     Mesh(Mesh&& other) noexcept;
     Mesh& operator=(Mesh&& other) noexcept;
 
-    void draw(Shader& shader) const;
+    void draw(const Shader& shader, uint32_t lod = 0) const;
+
+    // Binds the textures and, for packed arenas, the position dequantization
+    // uniforms ("positionOffset", "positionScale").
+    void bindMaterial(const Shader& shader) const;
+    void drawElements(uint32_t lod = 0) const;
+
+    uint32_t getLodCount() const;
+    uint32_t selectLod(float distance, float projectionScale) const;
+    // Reports the on-screen size of the mesh to the TextureStreamer.
+    void requestTextures(float distance, float projectionScale) const;
+    GeometryArena::Range getLodRange(uint32_t lod) const;
+
+    uint32_t getVertexArray() const;
+    uint64_t getTextureKey() const;
+
+    bool hasGeometry() const;
+    std::optional<MeshHit> intersect(const Ray& ray, float maxDistance) const;
+
+    const AABB& getBounds() const;
+    const BoundingSphere& getBoundingSphere() const;
+
+    const GeometryArena& getArena() const;
 
 private:
     Mesh() = default;
 
+    void initialize(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::vector<Texture> textures, std::span<const MeshLod> lods);
+
     std::vector<Vertex> m_vertices;
     std::vector<uint32_t> m_indices;
     std::vector<Texture> m_textures;
+    std::vector<std::string> m_samplerNames;
+    uint64_t m_textureKey = 0;
+
+    mutable uint32_t m_samplerProgram = 0;
+    mutable std::vector<UniformHandle> m_samplerHandles;
+
+    std::shared_ptr<GeometryArena> m_arena;
+    GeometryArena::Range m_range;
+    std::vector<MeshLod> m_lods;
 
-    uint32_t m_vertexArray = 0;
-    uint32_t m_vertexBuffer = 0;
-    uint32_t m_elementBuffer = 0;
+    AABB m_bounds;
+    BoundingSphere m_boundingSphere;
 };
\ No newline at end of file
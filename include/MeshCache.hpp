@@ -0,0 +1,64 @@
+#pragma once
+
+#include "Mesh.hpp"
+
+#include <span>
+#include <vector>
+#include <optional>
+#include <string_view>
+
+
+// Binary cache of the processed meshes of a model file.
+//
+// The cache lives next to the source file ("<source>.meshcache") and holds the
+// final Vertex/index arrays, LOD ranges and texture references of every mesh, so a warm
+// start maps the file and uploads straight from it without running Assimp.
+// Vertices are stored either as Vertex or, for packed models, as PackedVertex
+// with the quantization box in the header; only one of the two spans of a
+// MeshView is filled.
+// It is invalidated when the source size/mtime change and its content hash no
+// longer matches.
+class MeshCache
+{
+public:
+    struct TextureRef
+    {
+        Texture::Type type;
+        std::string_view file;
+    };
+
+    struct MeshView
+    {
+        std::span<const Vertex> vertices;
+        std::span<const PackedVertex> packedVertices;
+        std::span<const uint32_t> indices;
+        std::span<const MeshLod> lods;
+        std::vector<TextureRef> textures;
+    };
+
+    static std::optional<MeshCache> open(std::string_view sourcePath);
+    static bool write(std::string_view sourcePath, const std::vector<MeshData>& meshes, VertexFormat format = VertexFormat::Float, const VertexQuantization& quantization = {});
+
+    ~MeshCache();
+
+    MeshCache(const MeshCache&) = delete;
+    MeshCache& operator=(const MeshCache&) = delete;
+
+    MeshCache(MeshCache&& other) noexcept;
+    MeshCache& operator=(MeshCache&& other) noexcept;
+
+    const std::vector<MeshView>& getMeshes() const;
+    VertexFormat getVertexFormat() const;
+    const VertexQuantization& getQuantization() const;
+
+private:
+    MeshCache() = default;
+
+    bool parse();
+
+    const uint8_t* m_data = nullptr;
+    size_t m_size = 0;
+    VertexFormat m_format = VertexFormat::Float;
+    VertexQuantization m_quantization;
+    std::vector<MeshView> m_meshes;
+};
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include "Mesh.hpp"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <memory_resource>
+
+
+// Post-transform vertex cache statistics of an index buffer, measured with a
+// FIFO cache simulation.
+struct VertexCacheStats
+{
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;
+    uint32_t missCount = 0;
+
+    // Average cache miss ratio: transformed vertices per triangle (0.5 - 3).
+    float getAcmr() const;
+
+    // Average transform to vertex ratio: transformed vertices per unique
+    // vertex (1 is ideal).
+    float getAtvr() const;
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other);
+};
+
+// Every pass takes the memory resource its working arrays are allocated from.
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+// Reorders triangles for post-transform cache locality (Forsyth's linear-speed
+// vertex cache optimization).
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+// Splits a cache-optimized index buffer into clusters at the points where the
+// cache restarts and sorts them outside-in, so likely occluders draw first.
+// Cache efficiency is unaffected because clusters only break at cold starts.
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+// Renumbers vertices in the order the index buffer first references them and
+// drops unreferenced ones, so vertex fetch walks memory linearly.
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::span<uint32_t> indices, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+struct MeshOptimizeStats
+{
+    VertexCacheStats before;
+    VertexCacheStats after;
+};
+
+// Runs the cache (and optionally the overdraw) pass on every LOD range, then
+// the vertex fetch pass. The returned statistics cover LOD 0.
+MeshOptimizeStats optimizeMesh(MeshData& mesh, bool sortForOverdraw, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
\ No newline at end of file
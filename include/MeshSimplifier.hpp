@@ -0,0 +1,23 @@
+#pragma once
+
+#include "Mesh.hpp"
+
+#include <span>
+#include <vector>
+#include <cstdint>
+#include <memory_resource>
+
+
+// Edge-collapse simplification driven by quadric error metrics (Garland &
+// Heckbert). Only the index buffer changes: every collapse moves a vertex
+// onto one of its existing neighbours, so all LODs share the vertex data.
+//
+// Vertices that share a position but not their attributes (UV/normal seams)
+// are never moved, which keeps texture seams intact at the cost of some
+// reduction around them.
+// The result and all working arrays are allocated from scratch.
+std::pmr::vector<uint32_t> simplifyMesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices, size_t targetIndexCount, float& resultError, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
+
+// Appends progressively halved LODs of mesh.indices to mesh.indices and
+// records their ranges and errors in mesh.lods (LOD 0 is the original).
+void generateLods(MeshData& mesh, std::pmr::memory_resource* scratch = std::pmr::get_default_resource());
\ No newline at end of file
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+
+// An RGBA8 image with its complete mip chain, built on the CPU so uploads do
+// not depend on the driver's glGenerateMipmap.
+//
+// Levels are 2x2 box-filtered (edge texels repeat for odd sizes) using SSE2
+// where available. sRGB images are averaged in linear space through lookup
+// tables; alpha is always filtered linearly.
+struct MipChain
+{
+    struct Level
+    {
+        size_t offset;
+        uint32_t width;
+        uint32_t height;
+    };
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<Level> levels;
+    std::vector<uint8_t> data;
+};
+
+// Accepts 1-4 channel 8-bit images; missing channels are filled in as the
+// GL would for GL_RED/GL_RG/GL_RGB (zero color, opaque alpha).
+MipChain buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, bool srgb, bool vectorized = true);
+
+// Copies levels [firstLevel, end) into a chain of their own.
+MipChain sliceMipChain(const MipChain& chain, uint32_t firstLevel);
\ No newline at end of file
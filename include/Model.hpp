@@ -1,7 +1,11 @@
 #pragma once
 
 #include "Mesh.hpp"
+#include "Frustum.hpp"
 #include "Shader.hpp"
+#include "RenderQueue.hpp"
+#include "IndirectDraw.hpp"
+#include "TextureLoader.hpp"
 
 #include <assimp/scene.h>
 #include <assimp/Importer.hpp>
@@ -12,10 +16,24 @@
 #include <string_view>
 
 
+struct ModelLoadOptions
+{
+    VertexFormat vertexFormat = VertexFormat::Float;
+
+    // Keep a CPU copy of the geometry after upload; needed for picking.
+    bool keepGeometry = true;
+};
+
 class Model
 {
 public:
-    static std::optional<Model> create(const std::string_view& path);
+    enum class DrawMode
+    {
+        Direct,
+        Indirect
+    };
+
+    static std::optional<Model> create(const std::string_view& path, const ModelLoadOptions& options = {});
 
     Model(const Model&) = delete;
     Model& operator=(const Model&) = delete;
@@ -23,16 +41,41 @@ public:
     Model(Model&&) noexcept = default;
     Model& operator=(Model&&) noexcept = default;
 
-    void draw(Shader& shader) const;
+    bool setDrawMode(DrawMode mode);
+    DrawMode getDrawMode() const;
+
+    CullStats cull(const Frustum& frustum);
+    void selectLods(const glm::vec3& viewPosition, float projectionScale, const glm::mat4& transform);
+    const CullStats& getCullStats() const;
+
+    const std::vector<Mesh>& getMeshes() const;
+
+    void draw(const Shader& shader) const;
+    void submit(RenderQueue& queue, const Shader& shader, const glm::mat4& transform, float depth) const;
 
 private:
     Model() = default;
 
-    void processNode(const aiNode* node, const aiScene* scene);
-    Mesh processMesh(const aiMesh* mesh, const aiScene* scene);
-    std::vector<Texture> loadMaterialTextures(const aiMaterial* mat, const aiTextureType aiType, Texture::Type type);
+    void prepareDrawLists();
+
+    static void collectMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& meshes);
+    static MeshData processMesh(const aiMesh* mesh);
+    std::vector<Texture> loadMeshTextures(const aiMesh* mesh, const aiScene* scene);
+    void loadMaterialTextures(const aiMaterial* mat, const aiTextureType aiType, Texture::Type type, std::vector<Texture>& textures);
+    std::optional<Texture> loadTexture(std::string_view file, Texture::Type type);
 
     std::vector<Mesh> m_meshes;
     std::string_view m_directory;
-    std::vector<Texture> m_loadedTextures;
+    std::vector<TextureLoader::Request> m_textureRequests;
+
+    DrawMode m_drawMode = DrawMode::Direct;
+    std::vector<uint32_t> m_drawOrder;
+
+    std::vector<BoundingSphere> m_boundingSpheres;
+    std::vector<AABB> m_bounds;
+    std::vector<uint8_t> m_visible;
+    std::vector<uint32_t> m_visibleOrder;
+    std::vector<uint32_t> m_lods;
+    CullStats m_cullStats;
+    mutable std::optional<IndirectDrawBuffer> m_indirectDraw;
 };
\ No newline at end of file
@@ -0,0 +1,143 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+
+// Frame profiler exporting Chrome trace-event JSON (chrome://tracing,
+// Perfetto).
+//
+// CPU zones are ProfileZone objects covering a scope. Each thread records
+// them into its own single-producer ring, so recording takes no lock; the
+// rings are drained on beginFrame(). A full ring drops zones instead of
+// blocking.
+//
+// GPU zones (GpuProfileZone) place GL_TIMESTAMP queries around their scope.
+// The queries of a frame are read back two frames later, when they are
+// normally available already; a frame whose results are still pending is
+// dropped rather than stalling. GPU times are mapped onto the CPU timeline
+// with a GL_TIMESTAMP reading taken at the start of every frame.
+//
+// Nothing is recorded until setEnabled(true). beginFrame(), the GPU zones and
+// writeTrace() must only be used from the GL thread.
+class Profiler
+{
+public:
+    static constexpr size_t RING_CAPACITY = 16384;
+    static constexpr size_t MAX_EVENTS = 1 << 21;
+    static constexpr uint32_t GPU_FRAMES = 3;
+    static constexpr uint32_t GPU_ZONES = 64;
+    static constexpr uint32_t NO_ZONE = ~0u;
+    static constexpr uint32_t GPU_THREAD = 0;
+
+    static Profiler& get();
+
+    Profiler(const Profiler&) = delete;
+    Profiler& operator=(const Profiler&) = delete;
+
+    static bool isEnabled();
+    void setEnabled(bool enabled);
+
+    // Names the calling thread in the trace. name must be a string literal or
+    // otherwise outlive the profiler.
+    void setThreadName(const char* name);
+
+    void beginFrame();
+    bool writeTrace(const std::string& path);
+
+    void recordCpuZone(const char* name, uint64_t start, uint64_t end);
+    uint32_t beginGpuZone(const char* name);
+    void endGpuZone(uint32_t zone);
+
+    uint64_t now() const;
+
+private:
+    struct Event
+    {
+        const char* name;
+        uint64_t start;
+        uint64_t end;
+        uint32_t thread;
+    };
+
+    struct Ring
+    {
+        std::array<Event, RING_CAPACITY> events;
+        std::atomic<size_t> head = 0;
+        std::atomic<size_t> tail = 0;
+        std::atomic<const char*> name = nullptr;
+        uint32_t thread;
+    };
+
+    struct GpuFrame
+    {
+        std::array<uint32_t, 2 * GPU_ZONES> queries {};
+        std::array<const char*, GPU_ZONES> names {};
+        std::array<bool, GPU_ZONES> ended {};
+        uint32_t zoneCount = 0;
+        uint32_t lastQuery = 0;
+        int64_t gpuBase = 0;
+        uint64_t cpuBase = 0;
+    };
+
+    Profiler();
+
+    Ring& getRing();
+    void drainRings();
+    void resolveGpuFrame(GpuFrame& frame, bool wait);
+    void addEvent(const Event& event);
+
+    static std::atomic<bool> s_enabled;
+
+    const std::chrono::steady_clock::time_point m_epoch;
+
+    std::mutex m_ringMutex;
+    std::vector<std::unique_ptr<Ring>> m_rings;
+    std::atomic<size_t> m_droppedZones = 0;
+
+    std::array<GpuFrame, GPU_FRAMES> m_gpuFrames;
+    uint32_t m_gpuFrame = 0;
+    bool m_gpuSupported = false;
+    bool m_gpuInitialized = false;
+    size_t m_droppedGpuFrames = 0;
+
+    std::vector<Event> m_events;
+    size_t m_droppedEvents = 0;
+};
+
+// Records the lifetime of the scope as a CPU zone. name must be a string
+// literal or otherwise outlive the profiler.
+class ProfileZone
+{
+public:
+    explicit ProfileZone(const char* name);
+    ~ProfileZone();
+
+    ProfileZone(const ProfileZone&) = delete;
+    ProfileZone& operator=(const ProfileZone&) = delete;
+
+private:
+    const char* m_name;
+    uint64_t m_start = 0;
+    bool m_active = false;
+};
+
+// Records the GPU time of the commands issued within the scope.
+class GpuProfileZone
+{
+public:
+    explicit GpuProfileZone(const char* name);
+    ~GpuProfileZone();
+
+    GpuProfileZone(const GpuProfileZone&) = delete;
+    GpuProfileZone& operator=(const GpuProfileZone&) = delete;
+
+private:
+    uint32_t m_zone = Profiler::NO_ZONE;
+};
\ No newline at end of file
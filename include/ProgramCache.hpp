@@ -0,0 +1,61 @@
+#pragma once
+
+#include <string>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+
+// On-disk cache of linked program binaries (GL_ARB_get_program_binary).
+//
+// Binaries are stored as "<directory>/<key>.progbin", keyed by a hash of the
+// shader sources and the GL vendor, renderer and version strings, so a driver
+// update misses instead of feeding the driver a binary it may reject. A
+// binary the driver still rejects is counted and the caller compiles from
+// source; the fresh binary then replaces it.
+// Must only be used from the GL thread.
+class ProgramCache
+{
+public:
+    static constexpr std::string_view DIRECTORY = "shaders/cache";
+
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t rejected = 0;
+        size_t compiled = 0;
+        size_t stored = 0;
+        double loadTime = 0.0;
+        double compileTime = 0.0;
+    };
+
+    static ProgramCache& get();
+
+    ProgramCache(const ProgramCache&) = delete;
+    ProgramCache& operator=(const ProgramCache&) = delete;
+
+    bool isSupported();
+
+    uint64_t makeKey(std::string_view vertexSource, std::string_view fragmentSource);
+
+    // Returns a linked program, or nullopt when there is no usable binary.
+    std::optional<uint32_t> load(uint64_t key);
+    bool store(uint64_t key, uint32_t program);
+
+    // Records a program built from source, whether or not it was stored.
+    void addCompile(double milliseconds);
+
+    Stats getStats() const;
+
+private:
+    ProgramCache() = default;
+
+    std::string getPath(uint64_t key) const;
+
+    bool m_initialized = false;
+    bool m_supported = false;
+    uint64_t m_driverHash = 0;
+
+    Stats m_stats;
+};
\ No newline at end of file
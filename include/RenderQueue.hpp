@@ -0,0 +1,55 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "Shader.hpp"
+#include "UniformRing.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+
+
+class Model;
+
+// Collects the draws of a frame as packets tagged with a 64-bit sort key
+// (program | texture set | vertex array | depth) and issues them in key order,
+// so draws sharing state end up next to each other and the GLState shadow
+// cache can drop the redundant binds between them. Models in indirect draw
+// mode go in as a single packet keyed by their first mesh. Transforms are
+// pushed into the frame's UniformRing as Object blocks.
+class RenderQueue
+{
+public:
+    explicit RenderQueue(float maxDepth = 100.0f);
+
+    void submit(const Shader& shader, const Mesh& mesh, const glm::mat4& transform, float depth, uint32_t lod = 0);
+    void submit(const Shader& shader, const Model& model, const Mesh& keyMesh, const glm::mat4& transform, float depth);
+    void flush(UniformRing& uniforms);
+
+    size_t getPacketCount() const;
+
+private:
+    struct Packet
+    {
+        const Shader* shader;
+        const Mesh* mesh;
+        const Model* model;
+        glm::mat4 transform;
+        uint32_t lod;
+    };
+
+    struct SortEntry
+    {
+        uint64_t key;
+        uint32_t packet;
+    };
+
+    uint64_t createKey(const Shader& shader, const Mesh& mesh, float depth) const;
+    void sort();
+
+    float m_maxDepth;
+
+    std::vector<Packet> m_packets;
+    std::vector<SortEntry> m_entries;
+    std::vector<SortEntry> m_scratch;
+};
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+
+
+// Per-frame counters of the draws the renderer issues. drawCalls counts
+// glDraw* calls, drawCommands the meshes they draw (a multi-draw counts once
+// in the former and once per command in the latter). Counts of individual GL
+// calls come from GLInstrumentation, which sees every entry point.
+class RenderStats
+{
+public:
+    struct Counters
+    {
+        uint64_t drawCalls = 0;
+        uint64_t drawCommands = 0;
+        uint64_t triangles = 0;
+    };
+
+    static void countDraw(uint64_t commands, uint64_t triangles);
+
+    static const Counters& get();
+    static void reset();
+
+private:
+    static Counters s_counters;
+};
\ No newline at end of file
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "Bvh.hpp"
+#include "Model.hpp"
+#include "Shader.hpp"
+#include "Frustum.hpp"
+#include "RenderQueue.hpp"
+
+#include <glm/glm.hpp>
+
+#include <vector>
+#include <cstdint>
+#include <optional>
+
+
+// Placed model instances with a BVH over the world-space bounds of every
+// one of their meshes, used for frustum culling and picking.
+//
+// Adding an instance rebuilds the BVH on the next query; moving one only
+// refits it. Submitted meshes use the LOD whose error projects to less than
+// a pixel at their distance.
+//
+// Instances of models in indirect draw mode stay in the BVH for picking, but
+// are culled and submitted by their Model as one multi-draw packet. The cull
+// state lives in the Model, so such a model must only be placed once.
+class Scene
+{
+public:
+    struct PickResult
+    {
+        uint32_t instance;
+        uint32_t mesh;
+        uint32_t triangle;
+        float distance;
+        glm::vec3 position;
+    };
+
+    uint32_t addInstance(Model& model, const Shader& shader, const glm::mat4& transform);
+    void setTransform(uint32_t instance, const glm::mat4& transform);
+
+    const std::vector<uint32_t>& cull(const Frustum& frustum);
+    void submit(RenderQueue& queue, const glm::mat4& viewProjection, const glm::vec3& viewPosition, float projectionScale);
+
+    std::optional<PickResult> pick(const Ray& ray, float maxDistance = 1000.0f);
+
+    const CullStats& getCullStats() const;
+
+private:
+    struct Instance
+    {
+        Model* model;
+        const Shader* shader;
+        glm::mat4 transform;
+        glm::mat4 inverseTransform;
+        uint32_t firstItem;
+    };
+
+    struct Item
+    {
+        uint32_t instance;
+        uint32_t mesh;
+    };
+
+    void update();
+    void updateBounds(const Instance& instance);
+
+    std::vector<Instance> m_instances;
+    std::vector<Item> m_items;
+    std::vector<AABB> m_itemBounds;
+
+    Bvh m_bvh;
+    bool m_needsBuild = false;
+    bool m_needsRefit = false;
+
+    std::vector<uint32_t> m_visibleItems;
+    CullStats m_cullStats;
+};
\ No newline at end of file
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+
+
+// Monotonic memory resource for short-lived load-time data. Allocations are
+// bump-pointer and deallocation is a no-op; everything is handed back at once
+// by release() or the destructor. Counts what went through it so loads can
+// report their scratch footprint.
+class ScratchArena : public std::pmr::memory_resource
+{
+public:
+    struct Stats
+    {
+        size_t allocationCount = 0;
+        size_t allocatedBytes = 0;
+
+        // Most memory the arena held from the heap at any one time.
+        size_t peakBytes = 0;
+    };
+
+    explicit ScratchArena(size_t initialSize = 64 * 1024);
+
+    ScratchArena(const ScratchArena&) = delete;
+    ScratchArena& operator=(const ScratchArena&) = delete;
+
+    void release();
+
+    const Stats& getStats() const;
+
+private:
+    class Upstream : public std::pmr::memory_resource
+    {
+    public:
+        size_t reservedBytes = 0;
+        size_t peakBytes = 0;
+
+    private:
+        void* do_allocate(size_t bytes, size_t alignment) override;
+        void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+        bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+    };
+
+    void* do_allocate(size_t bytes, size_t alignment) override;
+    void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+    Upstream m_upstream;
+    std::pmr::monotonic_buffer_resource m_buffer;
+    mutable Stats m_stats;
+};
\ No newline at end of file
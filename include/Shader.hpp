@@ -3,11 +3,20 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include <string>
 #include <string_view>
+#include <unordered_map>
 
 #include <optional>
 
 
+struct UniformHandle
+{
+    int32_t location = -1;
+
+    bool isValid() const { return location != -1; }
+};
+
 class Shader
 {
 public:
@@ -25,14 +34,41 @@ public:
 
     void use() const;
 
+    UniformHandle getUniform(std::string_view name) const;
+
+    // Uniforms set for every draw, resolved once when the program is created.
+    // Invalid when the program does not use them.
+    UniformHandle getPositionOffsetUniform() const;
+    UniformHandle getPositionScaleUniform() const;
+
     void setBool(std::string_view name, bool value) const;
     void setInt(std::string_view name, int value) const;
     void setFloat(std::string_view name, float value) const;
     void setMat4(std::string_view name, const glm::mat4& value) const;
     void setVec3(std::string_view name, const glm::vec3& value) const;
 
+    void setBool(UniformHandle handle, bool value) const;
+    void setInt(UniformHandle handle, int value) const;
+    void setFloat(UniformHandle handle, float value) const;
+    void setMat4(UniformHandle handle, const glm::mat4& value) const;
+    void setVec3(UniformHandle handle, const glm::vec3& value) const;
+
 private:
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view name) const { return std::hash<std::string_view>{}(name); }
+    };
+
     Shader(uint32_t id);
 
+    UniformHandle findUniform(std::string_view name) const;
+    void introspectUniforms();
+    void bindUniformBlocks();
+
     uint32_t m_id = 0;
+    std::unordered_map<std::string, int32_t, StringHash, std::equal_to<>> m_uniforms;
+    UniformHandle m_positionOffset;
+    UniformHandle m_positionScale;
 };
\ No newline at end of file
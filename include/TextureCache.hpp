@@ -0,0 +1,102 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "TextureLoader.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <functional>
+#include <string_view>
+#include <unordered_map>
+
+
+// Process-wide registry of the textures currently alive, shared by every model.
+//
+// Entries are keyed by the canonical file path plus the load parameters and only
+// hold weak references: the texture is freed as soon as the last Texture using
+// it goes away, and its entry is dropped with it. A miss creates the placeholder
+// texture and queues a TextureLoader request for it.
+//
+// Lookups go by the directory and file name as the model spells them; the path
+// is only joined and canonicalized the first time a spelling is seen.
+// Must only be used from the GL thread.
+class TextureCache
+{
+public:
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t residentCount = 0;
+        size_t residentBytes = 0;
+    };
+
+    static TextureCache& get();
+
+    TextureCache(const TextureCache&) = delete;
+    TextureCache& operator=(const TextureCache&) = delete;
+
+    std::shared_ptr<TextureResource> acquire(std::string_view directory, std::string_view file, const TextureParams& params, std::vector<TextureLoader::Request>& requests);
+
+    Stats getStats() const;
+
+private:
+    struct StringHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(std::string_view text) const
+        {
+            return std::hash<std::string_view>{}(text);
+        }
+    };
+
+    struct Spelling
+    {
+        std::string_view directory;
+        std::string_view file;
+        uint32_t flags;
+    };
+
+    struct StoredSpelling
+    {
+        std::string directory;
+        std::string file;
+        uint32_t flags;
+
+        operator Spelling() const
+        {
+            return { directory, file, flags };
+        }
+    };
+
+    struct SpellingHash
+    {
+        using is_transparent = void;
+
+        size_t operator()(const Spelling& spelling) const;
+    };
+
+    struct SpellingEqual
+    {
+        using is_transparent = void;
+
+        bool operator()(const Spelling& lhs, const Spelling& rhs) const;
+    };
+
+    template<typename Value>
+    using StringMap = std::unordered_map<std::string, Value, StringHash, std::equal_to<>>;
+
+    TextureCache() = default;
+
+    // Returns the entry key for a spelling, resolving it on first use.
+    const std::string& getKey(const Spelling& spelling);
+
+    std::unordered_map<StoredSpelling, std::string, SpellingHash, SpellingEqual> m_keys;
+    StringMap<std::weak_ptr<TextureResource>> m_entries;
+
+    size_t m_hits = 0;
+    size_t m_misses = 0;
+};
\ No newline at end of file
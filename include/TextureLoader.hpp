@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "MipChain.hpp"
+
+#include <mutex>
+#include <deque>
+#include <chrono>
+#include <memory>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+#include <condition_variable>
+
+
+struct TextureParams
+{
+    bool flipVertically = true;
+    // Color data: mip levels are averaged in linear space.
+    bool srgb = false;
+    // Large images are handed to the TextureStreamer (uncompressed ones only).
+    bool streamed = false;
+};
+
+// Decodes texture files and builds their mip chains on a pool of worker
+// threads, then hands the levels back to the GL thread through a bounded queue.
+//
+// Requests refer to a texture that already holds a 1x1 placeholder image (see
+// TextureCache), so it stays usable while loading; upload() later replaces the
+// placeholder with the decoded image within a per-call time budget. Textures
+// released before their turn are skipped.
+//
+// A pre-compressed "<name>.ktx2" next to the requested image is loaded instead
+// of decoding it, unless its orientation does not match the request or the GL
+// context cannot sample its format (the image is then decoded after all).
+class TextureLoader
+{
+public:
+    struct Request
+    {
+        std::weak_ptr<TextureResource> texture;
+        std::string path;
+        TextureParams params;
+        bool allowCompressed = true;
+        // Set for page-ins of a streamed texture: the finest level to upload.
+        std::optional<uint32_t> firstLevel;
+    };
+
+    static TextureLoader& get();
+
+    ~TextureLoader();
+
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+
+    void submit(std::vector<Request>&& requests);
+
+    size_t upload(std::chrono::microseconds budget);
+    void finish();
+
+    size_t getPendingCount() const;
+
+private:
+    struct Decoded
+    {
+        Request request;
+        MipChain mips;
+        std::optional<Ktx2Image> compressed;
+    };
+
+    TextureLoader(size_t workerCount, size_t queueCapacity);
+
+    bool uploadNext();
+    void work();
+
+    std::vector<std::thread> m_workers;
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_requestAvailable;
+    std::condition_variable m_decodedAvailable;
+    std::condition_variable m_spaceAvailable;
+
+    std::deque<Request> m_requests;
+    std::deque<Decoded> m_decoded;
+
+    size_t m_capacity = 0;
+    size_t m_pending = 0;
+    bool m_stopping = false;
+};
\ No newline at end of file
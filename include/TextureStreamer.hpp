@@ -0,0 +1,90 @@
+#pragma once
+
+#include "Mesh.hpp"
+#include "MipChain.hpp"
+#include "TextureLoader.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <unordered_map>
+
+
+// Keeps large textures only partly in GPU memory.
+//
+// A streamed texture (TextureParams::streamed) is first uploaded with just its
+// mip tail, the levels of at most TAIL_SIZE texels, which is also kept in RAM.
+// Meshes report each frame how large they appear on screen; update() then
+// pages the finer levels they need back in through the TextureLoader. While
+// that would exceed the budget, the least recently used textures drop back to
+// their tail. Only streamed textures count against the budget.
+//
+// Image files cannot be decoded in part, so every page-in decodes the whole
+// source image again; only the tail is kept in RAM between page-ins. A texture
+// whose page-in fails stays at its current levels and is not requested again.
+// Must only be used from the GL thread.
+class TextureStreamer
+{
+public:
+    struct Stats
+    {
+        size_t streamedCount = 0;
+        size_t residentBytes = 0;
+        size_t pageIns = 0;
+        size_t evictions = 0;
+    };
+
+    static TextureStreamer& get();
+
+    TextureStreamer(const TextureStreamer&) = delete;
+    TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+    void setBudget(size_t bytes);
+
+    // Called by the loader on a streamed texture's first upload: keeps its tail
+    // and returns the finest level to upload.
+    uint32_t registerTexture(const std::shared_ptr<TextureResource>& texture, const TextureLoader::Request& request, const MipChain& mips);
+
+    // The texture is drawn about `pixels` wide on screen this frame.
+    void request(const std::shared_ptr<TextureResource>& texture, float pixels);
+
+    // Called by the loader when the source of a page-in could not be loaded.
+    void cancelPageIn(const TextureResource& texture);
+
+    // Call once per frame after all requests.
+    void update();
+
+    Stats getStats() const;
+
+private:
+    struct Entry
+    {
+        std::weak_ptr<TextureResource> texture;
+        std::string path;
+        TextureParams params;
+        MipChain tail;
+        uint32_t tailLevel;
+        std::vector<MipChain::Level> levels;
+        size_t size;
+        uint32_t wantedLevel;
+        uint32_t loadingLevel;
+        uint64_t lastUsedFrame;
+        bool failed;
+    };
+
+    TextureStreamer();
+
+    static size_t getResidentSize(const Entry& entry, uint32_t level);
+
+    Entry* findEvictionCandidate();
+    size_t evict(Entry& entry);
+
+    std::unordered_map<const TextureResource*, Entry> m_entries;
+    std::vector<TextureLoader::Request> m_requests;
+
+    size_t m_budget;
+    uint64_t m_frame = 0;
+    size_t m_pageIns = 0;
+    size_t m_evictions = 0;
+};
\ No newline at end of file
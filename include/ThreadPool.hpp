@@ -0,0 +1,73 @@
+#pragma once
+
+#include <mutex>
+#include <deque>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <functional>
+#include <condition_variable>
+
+
+// Fixed pool of worker threads for data-parallel CPU work.
+//
+// parallelFor() splits a range into chunks spread across per-worker queues.
+// Each worker drains its own queue from the back and steals from the front
+// of the others when it runs dry. The calling thread joins in as the last
+// worker, so the body sees a worker index below getWorkerCount() that is
+// unique among the threads running at that moment (use it to pick per-worker
+// scratch state).
+class ThreadPool
+{
+public:
+    using Body = std::function<void(size_t index, size_t worker)>;
+
+    static ThreadPool& get();
+
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t getWorkerCount() const;
+
+    // Runs body(index, worker) for every index in [0, count) and returns when
+    // all have finished. Calls from different threads are serialized.
+    void parallelFor(size_t count, const Body& body);
+
+private:
+    struct Job
+    {
+        const Body* body;
+        std::atomic<size_t> remaining;
+    };
+
+    struct Chunk
+    {
+        Job* job;
+        size_t begin;
+        size_t end;
+    };
+
+    struct Queue
+    {
+        std::mutex mutex;
+        std::deque<Chunk> chunks;
+    };
+
+    explicit ThreadPool(size_t threadCount);
+
+    bool runChunk(size_t worker);
+    void work(size_t worker);
+
+    std::vector<std::unique_ptr<Queue>> m_queues;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_callerMutex;
+
+    std::mutex m_mutex;
+    std::condition_variable m_chunksAvailable;
+    std::atomic<size_t> m_queuedChunks = 0;
+    bool m_stopping = false;
+};
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <string_view>
+
+
+// Binding points of the uniform blocks the shaders share. Shader::create
+// connects every block named in UNIFORM_BLOCK_NAMES to its binding, so GLSL
+// 4.10 shaders do not need layout(binding).
+enum class UniformBinding : uint32_t
+{
+    Camera = 0,
+    Light = 1,
+    Object = 2
+};
+
+constexpr std::array<std::string_view, 3> UNIFORM_BLOCK_NAMES { "Camera", "Light", "Object" };
+
+// The block structs mirror the std140 layouts in the shaders; vec3s are
+// stored as vec4 to match the std140 alignment rules.
+struct CameraBlock
+{
+    glm::mat4 projection;
+    glm::mat4 view;
+    glm::vec4 viewPosition;
+};
+
+struct LightBlock
+{
+    glm::vec4 position;
+    glm::vec4 ambient;
+    glm::vec4 diffuse;
+    glm::vec4 specular;
+    float constant;
+    float linear;
+    float quadratic;
+    float padding;
+};
+
+struct ObjectBlock
+{
+    glm::mat4 model;
+    glm::mat4 normalMatrix;
+};
+
+static_assert(sizeof(CameraBlock) == 144);
+static_assert(sizeof(LightBlock) == 80);
+static_assert(sizeof(ObjectBlock) == 128);
+
+// Per-frame uniform data in a single GL_UNIFORM_BUFFER split into FRAME_COUNT
+// regions. Each frame writes its blocks into the next region and binds them
+// with glBindBufferRange; a fence placed at the end of the frame guards the
+// region until the GPU is done with it, so the CPU only waits when it gets
+// FRAME_COUNT frames ahead.
+//
+// With GL 4.4 or ARB_buffer_storage the buffer is mapped once, persistently
+// and coherently, and blocks are plain memcpys. Otherwise every push is a
+// glBufferSubData into the same layout.
+//
+// A frame that outgrows its region moves to a new buffer with twice the frame
+// size; the old buffer is deleted once the frame has been issued.
+class UniformRing
+{
+public:
+    static constexpr uint32_t FRAME_COUNT = 3;
+
+    struct Slice
+    {
+        uint32_t buffer = 0;
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    static UniformRing create(size_t frameSize);
+
+    ~UniformRing();
+
+    UniformRing(const UniformRing&) = delete;
+    UniformRing& operator=(const UniformRing&) = delete;
+
+    UniformRing(UniformRing&& other) noexcept;
+    UniformRing& operator=(UniformRing&& other) noexcept;
+
+    void beginFrame();
+    void endFrame();
+
+    Slice push(const void* data, size_t size);
+    void bind(UniformBinding binding, Slice slice) const;
+
+    template<typename T>
+    Slice push(const T& block)
+    {
+        return push(&block, sizeof(T));
+    }
+
+    bool isPersistent() const;
+
+private:
+    struct RetiredBuffer
+    {
+        uint32_t buffer;
+        bool mapped;
+    };
+
+    UniformRing() = default;
+
+    void allocate(size_t frameSize);
+
+    uint32_t m_buffer = 0;
+    uint8_t* m_mapped = nullptr;
+    size_t m_frameSize = 0;
+    size_t m_alignment = 0;
+    uint32_t m_frame = 0;
+    size_t m_offset = 0;
+    size_t m_end = 0;
+    std::array<GLsync, FRAME_COUNT> m_fences {};
+    std::vector<RetiredBuffer> m_retiredBuffers;
+};
\ No newline at end of file
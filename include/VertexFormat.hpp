@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Bounds.hpp"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <cstddef>
+
+
+struct Vertex
+{
+    glm::vec3 position;
+    glm::vec3 normal;
+    glm::vec2 texCoords;
+};
+
+enum class VertexFormat : uint32_t
+{
+    Float,
+    Packed
+};
+
+// Half the size of Vertex: positions as 16-bit unorm relative to a bounding
+// box, normals octahedral-encoded as two 16-bit snorms and UVs as halves.
+struct PackedVertex
+{
+    uint16_t position[3];
+    uint16_t padding;
+    int16_t normal[2];
+    uint16_t texCoords[2];
+};
+
+static_assert(sizeof(PackedVertex) == 16);
+
+// Maps unorm positions back to object space: position = offset + value * scale.
+struct VertexQuantization
+{
+    glm::vec3 offset = glm::vec3(0.0f);
+    glm::vec3 scale = glm::vec3(1.0f);
+
+    static VertexQuantization fromBounds(const AABB& bounds);
+};
+
+size_t getVertexStride(VertexFormat format);
+
+PackedVertex packVertex(const Vertex& vertex, const VertexQuantization& quantization);
+Vertex unpackVertex(const PackedVertex& vertex, const VertexQuantization& quantization);
\ No newline at end of file
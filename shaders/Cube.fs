@@ -7,19 +7,6 @@ struct Fragment
     vec2 texCoords;
 };
 
-struct Light
-{
-    vec3 position;
-
-    vec3 ambient;
-    vec3 diffuse;
-    vec3 specular;
-
-    float constant;
-    float linear;
-    float quadratic;
-};
-
 struct Material
 {
     sampler2D diffuse;
@@ -28,30 +15,45 @@ struct Material
 };
 
 uniform Material material;
-uniform Light light;
-uniform vec3 viewPos;
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+} camera;
+
+layout (std140) uniform Light
+{
+    vec4 position;
+    vec4 ambient;
+    vec4 diffuse;
+    vec4 specular;
+    float constant;
+    float linear;
+    float quadratic;
+} light;
 
 in Fragment fragment;
 
 out vec4 FragColor;
 
-vec3 calculateLighting(Fragment fragment, Light light, Material material, vec3 viewPos)
+vec3 calculateLighting(Fragment fragment, Material material, vec3 viewPosition)
 {
-    vec3 ambient = light.ambient * vec3(texture(texture_diffuse1, fragment.texCoords));
+    vec3 ambient = light.ambient.rgb * vec3(texture(texture_diffuse1, fragment.texCoords));
 
     vec3 norm = normalize(fragment.normal);
-    vec3 lightDir = normalize(light.position - fragment.position);
+    vec3 lightDir = normalize(light.position.xyz - fragment.position);
     float diff = max(dot(norm, lightDir), 0.0f);
-    vec3 diffuse = light.diffuse * diff * vec3(texture(texture_diffuse1, fragment.texCoords));
+    vec3 diffuse = light.diffuse.rgb * diff * vec3(texture(texture_diffuse1, fragment.texCoords));
 
-    vec3 viewDir = normalize(viewPos - fragment.position);
+    vec3 viewDir = normalize(viewPosition - fragment.position);
     vec3 reflectDir = reflect(-lightDir, norm);
     float spec = pow(max(dot(viewDir, reflectDir), 0.0f), material.shininess);
-    vec3 specular = light.specular * spec * vec3(texture(material.specular, fragment.texCoords));
+    vec3 specular = light.specular.rgb * spec * vec3(texture(material.specular, fragment.texCoords));
 
     vec3 phong = ambient + diffuse + specular;
 
-    float distance = length(light.position - fragment.position);
+    float distance = length(light.position.xyz - fragment.position);
     float attenuation = 1.0f / (light.constant + light.linear * distance + light.quadratic * (distance * distance));
 
     phong *= attenuation;
@@ -62,7 +64,7 @@ vec3 calculateLighting(Fragment fragment, Light light, Material material, vec3 v
 
 void main()
 {
-    vec3 phong = calculateLighting(fragment, light, material, viewPos);
+    vec3 phong = calculateLighting(fragment, material, camera.viewPosition.xyz);
     
     FragColor = vec4(phong, 1.0f);
 }
@@ -11,16 +11,25 @@ struct Fragment
     vec2 texCoords;
 };
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+} camera;
+
+layout (std140) uniform Object
+{
+    mat4 model;
+    mat4 normalMatrix;
+} object;
 
 out Fragment fragment;
 
 void main()
 {
-    fragment.position = vec3(model * vec4(aPos, 1.0));
-    gl_Position = projection * view * vec4(fragment.position, 1.0);
-    fragment.normal = mat3(transpose(inverse(model))) * aNormal;
+    fragment.position = vec3(object.model * vec4(aPos, 1.0));
+    gl_Position = camera.projection * camera.view * vec4(fragment.position, 1.0);
+    fragment.normal = mat3(object.normalMatrix) * aNormal;
     fragment.texCoords = aTexCoords;
 }
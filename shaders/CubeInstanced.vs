@@ -0,0 +1,24 @@
+#version 410 core
+
+layout (location = 0) in vec3 position;
+layout (location = 1) in vec3 normal;
+layout (location = 2) in vec2 texCoord;
+layout (location = 3) in mat4 instanceModel;
+layout (location = 7) in vec4 instanceColor;
+
+out vec2 TexCoord;
+out vec4 Color;
+
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+} camera;
+
+void main()
+{
+    gl_Position = camera.projection * camera.view * instanceModel * vec4(position, 1.0);
+    TexCoord = texCoord;
+    Color = instanceColor;
+}
@@ -6,12 +6,21 @@ layout (location = 2) in vec2 texCoord;
 
 out vec2 TexCoord;
 
-uniform mat4 model;
-uniform mat4 view;
-uniform mat4 projection;
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+} camera;
+
+layout (std140) uniform Object
+{
+    mat4 model;
+    mat4 normalMatrix;
+} object;
 
 void main()
 {
-    gl_Position = projection * view * model * vec4(position, 1.0);
+    gl_Position = camera.projection * camera.view * object.model * vec4(position, 1.0);
     TexCoord = texCoord;
 }
\ No newline at end of file
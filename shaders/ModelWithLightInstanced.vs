@@ -0,0 +1,30 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec3 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+layout (location = 3) in mat4 aInstanceModel;
+
+struct Fragment
+{
+    vec3 position;
+    vec3 normal;
+    vec2 texCoords;
+};
+
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+} camera;
+
+out Fragment fragment;
+
+void main()
+{
+    fragment.position = vec3(aInstanceModel * vec4(aPos, 1.0));
+    gl_Position = camera.projection * camera.view * vec4(fragment.position, 1.0);
+    fragment.normal = mat3(transpose(inverse(aInstanceModel))) * aNormal;
+    fragment.texCoords = aTexCoords;
+}
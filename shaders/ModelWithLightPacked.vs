@@ -0,0 +1,52 @@
+#version 410 core
+
+layout (location = 0) in vec3 aPos;
+layout (location = 1) in vec2 aNormal;
+layout (location = 2) in vec2 aTexCoords;
+
+struct Fragment
+{
+    vec3 position;
+    vec3 normal;
+    vec2 texCoords;
+};
+
+layout (std140) uniform Camera
+{
+    mat4 projection;
+    mat4 view;
+    vec4 viewPosition;
+} camera;
+
+layout (std140) uniform Object
+{
+    mat4 model;
+    mat4 normalMatrix;
+} object;
+
+uniform vec3 positionOffset;
+uniform vec3 positionScale;
+
+out Fragment fragment;
+
+vec3 decodeOctahedral(vec2 encoded)
+{
+    vec3 normal = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+
+    if (normal.z < 0.0)
+    {
+        normal.xy = (1.0 - abs(encoded.yx)) * vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+    }
+
+    return normalize(normal);
+}
+
+void main()
+{
+    vec3 position = positionOffset + aPos * positionScale;
+
+    fragment.position = vec3(object.model * vec4(position, 1.0));
+    gl_Position = camera.projection * camera.view * vec4(fragment.position, 1.0);
+    fragment.normal = mat3(object.normalMatrix) * decodeOctahedral(aNormal);
+    fragment.texCoords = aTexCoords;
+}
@@ -0,0 +1,316 @@
+#include "Benchmark.hpp"
+
+#include "Logger.hpp"
+#include "GLInstrumentation.hpp"
+
+#include <GL/glew.h>
+#include <glm/gtc/constants.hpp>
+
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <format>
+#include <charconv>
+#include <algorithm>
+#include <functional>
+
+
+namespace
+{
+    constexpr std::array<SceneDescription, 2> SCENES
+    {
+        SceneDescription { "globe", "assets/globe/globe.obj", 0.1f, 3.0f },
+        SceneDescription { "backpack", "assets/backpack/backpack.obj", 1.0f, 6.0f }
+    };
+
+    bool parseNumber(std::string_view text, uint32_t& value)
+    {
+        const auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+        return error == std::errc() && end == text.data() + text.size();
+    }
+
+    bool parseSize(std::string_view text, uint32_t& width, uint32_t& height)
+    {
+        const size_t separator = text.find('x');
+
+        return separator != std::string_view::npos
+            && parseNumber(text.substr(0, separator), width)
+            && parseNumber(text.substr(separator + 1), height)
+            && width > 0 && height > 0;
+    }
+
+    struct Summary
+    {
+        double mean = 0.0;
+        double median = 0.0;
+        double p95 = 0.0;
+        double min = 0.0;
+        double max = 0.0;
+    };
+
+    Summary summarize(std::vector<double> values)
+    {
+        Summary summary;
+
+        if (values.empty())
+        {
+            return summary;
+        }
+
+        std::sort(values.begin(), values.end());
+
+        double sum = 0.0;
+
+        for (const double value : values)
+        {
+            sum += value;
+        }
+
+        summary.mean = sum / static_cast<double>(values.size());
+        summary.median = values[values.size() / 2];
+        summary.p95 = values[std::min(values.size() - 1, values.size() * 95 / 100)];
+        summary.min = values.front();
+        summary.max = values.back();
+
+        return summary;
+    }
+
+    std::string formatSummary(const Summary& summary)
+    {
+        return std::format("{{ \"mean\": {:.4f}, \"median\": {:.4f}, \"p95\": {:.4f}, \"min\": {:.4f}, \"max\": {:.4f} }}",
+            summary.mean, summary.median, summary.p95, summary.min, summary.max);
+    }
+
+    std::string escapeJson(std::string_view text)
+    {
+        std::string escaped;
+        escaped.reserve(text.size());
+
+        for (const char character : text)
+        {
+            if (character == '"' || character == '\\')
+            {
+                escaped.push_back('\\');
+            }
+
+            if (static_cast<unsigned char>(character) >= 0x20)
+            {
+                escaped.push_back(character);
+            }
+        }
+
+        return escaped;
+    }
+}
+
+
+const SceneDescription* findScene(std::string_view name)
+{
+    for (const SceneDescription& scene : SCENES)
+    {
+        if (scene.name == name)
+        {
+            return &scene;
+        }
+    }
+
+    return nullptr;
+}
+
+std::optional<CommandLine> parseCommandLine(int argc, char** argv)
+{
+    CommandLine commandLine;
+
+    for (int idx = 1; idx < argc; ++idx)
+    {
+        const std::string_view argument = argv[idx];
+        const bool hasValue = idx + 1 < argc;
+
+        if (argument == "--benchmark")
+        {
+            commandLine.benchmark = true;
+        }
+        else if (argument == "--scene" && hasValue)
+        {
+            commandLine.scene = argv[++idx];
+        }
+        else if (argument == "--frames" && hasValue && parseNumber(argv[idx + 1], commandLine.frames) && commandLine.frames > 0)
+        {
+            ++idx;
+        }
+        else if (argument == "--warmup" && hasValue && parseNumber(argv[idx + 1], commandLine.warmupFrames))
+        {
+            ++idx;
+        }
+        else if (argument == "--size" && hasValue && parseSize(argv[idx + 1], commandLine.width, commandLine.height))
+        {
+            ++idx;
+        }
+        else if (argument == "--output" && hasValue)
+        {
+            commandLine.output = argv[++idx];
+        }
+        else if (argument == "--trace" && hasValue)
+        {
+            commandLine.trace = argv[++idx];
+        }
+        else
+        {
+            logError("Invalid argument: {}", argument);
+            logInfo("Usage: {} [--scene globe|backpack] [--benchmark [--frames N] [--warmup N] [--size WxH] [--output FILE]] [--trace FILE]", argv[0]);
+            return std::nullopt;
+        }
+    }
+
+    if (findScene(commandLine.scene) == nullptr)
+    {
+        logError("Unknown scene: {}", commandLine.scene);
+        return std::nullopt;
+    }
+
+    return commandLine;
+}
+
+Camera getBenchmarkCamera(uint32_t frame, uint32_t frameCount, float orbitRadius)
+{
+    const float angle = glm::two_pi<float>() * static_cast<float>(frame) / static_cast<float>(frameCount);
+    const glm::vec3 position(orbitRadius * std::sin(angle), 0.25f * orbitRadius * std::sin(2.0f * angle), orbitRadius * std::cos(angle));
+    const glm::vec3 direction = glm::normalize(-position);
+
+    const float yaw = glm::degrees(std::atan2(direction.z, direction.x));
+    const float pitch = glm::degrees(std::asin(direction.y));
+
+    return Camera(position, glm::vec3(0.0f, 1.0f, 0.0f), yaw, pitch);
+}
+
+std::optional<OffscreenTarget> OffscreenTarget::create(uint32_t width, uint32_t height)
+{
+    OffscreenTarget target;
+    target.m_width = width;
+    target.m_height = height;
+
+    glGenRenderbuffers(1, &target.m_color);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.m_color);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    glGenRenderbuffers(1, &target.m_depth);
+    glBindRenderbuffer(GL_RENDERBUFFER, target.m_depth);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, width, height);
+
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &target.m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, target.m_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.m_color);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER, target.m_depth);
+
+    const GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE)
+    {
+        logError("Offscreen framebuffer is incomplete: {:#x}", status);
+        return std::nullopt;
+    }
+
+    return std::make_optional(std::move(target));
+}
+
+OffscreenTarget::~OffscreenTarget()
+{
+    glDeleteFramebuffers(1, &m_framebuffer);
+    glDeleteRenderbuffers(1, &m_color);
+    glDeleteRenderbuffers(1, &m_depth);
+}
+
+OffscreenTarget::OffscreenTarget(OffscreenTarget&& other) noexcept
+{
+    std::swap(m_framebuffer, other.m_framebuffer);
+    std::swap(m_color, other.m_color);
+    std::swap(m_depth, other.m_depth);
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+}
+
+OffscreenTarget& OffscreenTarget::operator=(OffscreenTarget&& other) noexcept
+{
+    std::swap(m_framebuffer, other.m_framebuffer);
+    std::swap(m_color, other.m_color);
+    std::swap(m_depth, other.m_depth);
+    std::swap(m_width, other.m_width);
+    std::swap(m_height, other.m_height);
+
+    return *this;
+}
+
+void OffscreenTarget::bind() const
+{
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_width, m_height);
+}
+
+void BenchmarkRecorder::addFrame(double cpuTime, double frameTime, const RenderStats::Counters& counters, uint64_t glCalls)
+{
+    m_frames.push_back({ cpuTime, frameTime, counters, glCalls });
+}
+
+bool BenchmarkRecorder::write(const CommandLine& commandLine, std::string_view renderer, std::string_view version) const
+{
+    auto summarizeFrames = [this](const std::function<double(const Frame&)>& select)
+    {
+        std::vector<double> values;
+        values.reserve(m_frames.size());
+
+        for (const Frame& frame : m_frames)
+        {
+            values.push_back(select(frame));
+        }
+
+        return formatSummary(summarize(std::move(values)));
+    };
+
+    const std::string glCalls = GLInstrumentation::ENABLED
+        ? std::format(",\n  \"glCalls\": {}", summarizeFrames([](const Frame& frame) { return static_cast<double>(frame.glCalls); }))
+        : std::string();
+
+    const std::string json = std::format(
+        "{{\n"
+        "  \"scene\": \"{}\",\n"
+        "  \"renderer\": \"{}\",\n"
+        "  \"version\": \"{}\",\n"
+        "  \"width\": {},\n"
+        "  \"height\": {},\n"
+        "  \"frames\": {},\n"
+        "  \"cpuTimeMs\": {},\n"
+        "  \"frameTimeMs\": {},\n"
+        "  \"drawCalls\": {},\n"
+        "  \"drawCommands\": {},\n"
+        "  \"triangles\": {}{}\n"
+        "}}\n",
+        escapeJson(commandLine.scene), escapeJson(renderer), escapeJson(version),
+        commandLine.width, commandLine.height, m_frames.size(),
+        summarizeFrames([](const Frame& frame) { return frame.cpuTime; }),
+        summarizeFrames([](const Frame& frame) { return frame.frameTime; }),
+        summarizeFrames([](const Frame& frame) { return static_cast<double>(frame.counters.drawCalls); }),
+        summarizeFrames([](const Frame& frame) { return static_cast<double>(frame.counters.drawCommands); }),
+        summarizeFrames([](const Frame& frame) { return static_cast<double>(frame.counters.triangles); }),
+        glCalls);
+
+    FILE* file = std::fopen(commandLine.output.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        logError("Failed to open benchmark output: {}", commandLine.output);
+        return false;
+    }
+
+    const bool result = std::fwrite(json.data(), json.size(), 1, file) == 1;
+
+    if (std::fclose(file) != 0 || !result)
+    {
+        logError("Failed to write benchmark output: {}", commandLine.output);
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,119 @@
+#include "Bounds.hpp"
+
+#include "Mesh.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+
+Ray Ray::transformed(const glm::mat4& transform) const
+{
+    // The direction is deliberately left unnormalized so distances along the
+    // transformed ray match the ones along the original ray.
+    return Ray { glm::vec3(transform * glm::vec4(origin, 1.0f)), glm::vec3(transform * glm::vec4(direction, 0.0f)) };
+}
+
+AABB AABB::fromVertices(std::span<const Vertex> vertices)
+{
+    AABB bounds;
+
+    for (const Vertex& vertex : vertices)
+    {
+        bounds.expand(vertex.position);
+    }
+
+    return bounds;
+}
+
+bool AABB::isEmpty() const
+{
+    return min.x > max.x || min.y > max.y || min.z > max.z;
+}
+
+glm::vec3 AABB::getCenter() const
+{
+    return (min + max) * 0.5f;
+}
+
+glm::vec3 AABB::getExtents() const
+{
+    return (max - min) * 0.5f;
+}
+
+void AABB::expand(const glm::vec3& point)
+{
+    min = glm::min(min, point);
+    max = glm::max(max, point);
+}
+
+void AABB::expand(const AABB& other)
+{
+    min = glm::min(min, other.min);
+    max = glm::max(max, other.max);
+}
+
+AABB AABB::transformed(const glm::mat4& transform) const
+{
+    if (isEmpty())
+    {
+        return *this;
+    }
+
+    // Arvo's method: the transformed extents are the absolute rotation/scale
+    // part applied to the local extents.
+    const glm::vec3 center = glm::vec3(transform * glm::vec4(getCenter(), 1.0f));
+    const glm::vec3 extents = getExtents();
+
+    glm::vec3 newExtents(0.0f);
+
+    for (int column = 0; column < 3; ++column)
+    {
+        newExtents += glm::abs(glm::vec3(transform[column])) * extents[column];
+    }
+
+    AABB result;
+    result.min = center - newExtents;
+    result.max = center + newExtents;
+
+    return result;
+}
+
+bool AABB::intersects(const Ray& ray, const glm::vec3& inverseDirection, float maxDistance, float& distance) const
+{
+    const glm::vec3 t0 = (min - ray.origin) * inverseDirection;
+    const glm::vec3 t1 = (max - ray.origin) * inverseDirection;
+
+    const glm::vec3 tSmall = glm::min(t0, t1);
+    const glm::vec3 tLarge = glm::max(t0, t1);
+
+    const float tNear = std::max({ tSmall.x, tSmall.y, tSmall.z, 0.0f });
+    const float tFar = std::min({ tLarge.x, tLarge.y, tLarge.z, maxDistance });
+
+    distance = tNear;
+
+    return tNear <= tFar;
+}
+
+BoundingSphere BoundingSphere::fromVertices(std::span<const Vertex> vertices, const AABB& bounds)
+{
+    BoundingSphere sphere;
+
+    if (bounds.isEmpty())
+    {
+        return sphere;
+    }
+
+    sphere.center = bounds.getCenter();
+
+    float radiusSquared = 0.0f;
+
+    for (const Vertex& vertex : vertices)
+    {
+        const glm::vec3 offset = vertex.position - sphere.center;
+        radiusSquared = std::max(radiusSquared, glm::dot(offset, offset));
+    }
+
+    sphere.radius = std::sqrt(radiusSquared);
+
+    return sphere;
+}
\ No newline at end of file
@@ -0,0 +1,317 @@
+#include "Bvh.hpp"
+
+#include <array>
+#include <limits>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint32_t BIN_COUNT = 12;
+    constexpr uint32_t MAX_LEAF_SIZE = 4;
+    constexpr size_t STACK_SIZE = 64;
+    constexpr uint32_t MAX_DEPTH = STACK_SIZE - 2;
+
+    float surfaceArea(const AABB& bounds)
+    {
+        if (bounds.isEmpty())
+        {
+            return 0.0f;
+        }
+
+        const glm::vec3 size = bounds.max - bounds.min;
+        return 2.0f * (size.x * size.y + size.y * size.z + size.z * size.x);
+    }
+}
+
+
+Bvh Bvh::build(std::span<const AABB> bounds)
+{
+    Bvh bvh;
+
+    bvh.m_items.resize(bounds.size());
+    std::vector<glm::vec3> centroids(bounds.size());
+
+    for (uint32_t idx = 0; idx < bounds.size(); ++idx)
+    {
+        bvh.m_items[idx] = idx;
+        centroids[idx] = bounds[idx].getCenter();
+    }
+
+    bvh.m_nodes.reserve(bounds.empty() ? 1 : 2 * bounds.size() - 1);
+    bvh.m_nodes.push_back(Node { glm::vec3(0.0f), 0, glm::vec3(0.0f), static_cast<uint32_t>(bounds.size()) });
+
+    if (!bounds.empty())
+    {
+        bvh.subdivide(0, 0, bounds, centroids);
+    }
+
+    return bvh;
+}
+
+void Bvh::refit(std::span<const AABB> bounds)
+{
+    if (m_items.empty())
+    {
+        return;
+    }
+
+    for (size_t nodeIdx = m_nodes.size(); nodeIdx-- > 0;)
+    {
+        Node& node = m_nodes[nodeIdx];
+        AABB nodeBounds;
+
+        if (node.isLeaf())
+        {
+            for (uint32_t idx = 0; idx < node.count; ++idx)
+            {
+                nodeBounds.expand(bounds[m_items[node.leftOrFirst + idx]]);
+            }
+        }
+        else
+        {
+            const Node& left = m_nodes[node.leftOrFirst];
+            const Node& right = m_nodes[node.leftOrFirst + 1];
+
+            nodeBounds.min = glm::min(left.min, right.min);
+            nodeBounds.max = glm::max(left.max, right.max);
+        }
+
+        node.min = nodeBounds.min;
+        node.max = nodeBounds.max;
+    }
+}
+
+void Bvh::queryFrustum(const Frustum& frustum, std::vector<uint32_t>& items) const
+{
+    if (m_items.empty())
+    {
+        return;
+    }
+
+    std::array<uint32_t, STACK_SIZE> stack;
+    size_t stackSize = 0;
+
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const Node& node = m_nodes[stack[--stackSize]];
+
+        if (!frustum.intersects(AABB { node.min, node.max }))
+        {
+            continue;
+        }
+
+        if (node.isLeaf())
+        {
+            items.insert(items.end(), m_items.begin() + node.leftOrFirst, m_items.begin() + node.leftOrFirst + node.count);
+            continue;
+        }
+
+        stack[stackSize++] = node.leftOrFirst + 1;
+        stack[stackSize++] = node.leftOrFirst;
+    }
+}
+
+std::optional<Bvh::RayHit> Bvh::queryRay(const Ray& ray, float maxDistance, const ItemIntersector& intersect) const
+{
+    if (m_items.empty())
+    {
+        return std::nullopt;
+    }
+
+    const glm::vec3 inverseDirection = 1.0f / ray.direction;
+
+    std::optional<RayHit> closest;
+    float closestDistance = maxDistance;
+
+    std::array<uint32_t, STACK_SIZE> stack;
+    size_t stackSize = 0;
+
+    float rootDistance;
+
+    if (AABB { m_nodes[0].min, m_nodes[0].max }.intersects(ray, inverseDirection, closestDistance, rootDistance))
+    {
+        stack[stackSize++] = 0;
+    }
+
+    while (stackSize > 0)
+    {
+        const Node& node = m_nodes[stack[--stackSize]];
+
+        if (node.isLeaf())
+        {
+            for (uint32_t idx = 0; idx < node.count; ++idx)
+            {
+                const uint32_t item = m_items[node.leftOrFirst + idx];
+
+                if (std::optional<float> distance = intersect(item, ray, closestDistance))
+                {
+                    closestDistance = *distance;
+                    closest = RayHit { item, *distance };
+                }
+            }
+
+            continue;
+        }
+
+        uint32_t near = node.leftOrFirst;
+        uint32_t far = node.leftOrFirst + 1;
+
+        float nearDistance;
+        float farDistance;
+
+        bool hitNear = AABB { m_nodes[near].min, m_nodes[near].max }.intersects(ray, inverseDirection, closestDistance, nearDistance);
+        bool hitFar = AABB { m_nodes[far].min, m_nodes[far].max }.intersects(ray, inverseDirection, closestDistance, farDistance);
+
+        if (hitNear && hitFar && farDistance < nearDistance)
+        {
+            std::swap(near, far);
+        }
+
+        // Push the far child first so the near one is visited first and
+        // tightens closestDistance before the far subtree is entered.
+        if (hitNear && hitFar)
+        {
+            stack[stackSize++] = far;
+            stack[stackSize++] = near;
+        }
+        else if (hitNear)
+        {
+            stack[stackSize++] = node.leftOrFirst;
+        }
+        else if (hitFar)
+        {
+            stack[stackSize++] = node.leftOrFirst + 1;
+        }
+    }
+
+    return closest;
+}
+
+size_t Bvh::getNodeCount() const
+{
+    return m_nodes.size();
+}
+
+void Bvh::subdivide(uint32_t nodeIdx, uint32_t depth, std::span<const AABB> bounds, std::span<const glm::vec3> centroids)
+{
+    const uint32_t first = m_nodes[nodeIdx].leftOrFirst;
+    const uint32_t count = m_nodes[nodeIdx].count;
+
+    AABB nodeBounds;
+    AABB centroidBounds;
+
+    for (uint32_t idx = first; idx < first + count; ++idx)
+    {
+        nodeBounds.expand(bounds[m_items[idx]]);
+        centroidBounds.expand(centroids[m_items[idx]]);
+    }
+
+    m_nodes[nodeIdx].min = nodeBounds.min;
+    m_nodes[nodeIdx].max = nodeBounds.max;
+
+    // Traversal uses a fixed-size stack, so the tree depth is capped.
+    if (count <= 1 || depth >= MAX_DEPTH)
+    {
+        return;
+    }
+
+    // Binned SAH: evaluate BIN_COUNT - 1 candidate planes per axis.
+    int32_t bestAxis = -1;
+    uint32_t bestSplit = 0;
+    float bestCost = std::numeric_limits<float>::max();
+
+    for (int32_t axis = 0; axis < 3; ++axis)
+    {
+        const float axisMin = centroidBounds.min[axis];
+        const float axisExtent = centroidBounds.max[axis] - axisMin;
+
+        if (axisExtent <= 0.0f)
+        {
+            continue;
+        }
+
+        std::array<AABB, BIN_COUNT> binBounds;
+        std::array<uint32_t, BIN_COUNT> binCounts {};
+
+        const float scale = BIN_COUNT / axisExtent;
+
+        for (uint32_t idx = first; idx < first + count; ++idx)
+        {
+            const uint32_t item = m_items[idx];
+            const uint32_t bin = std::min(BIN_COUNT - 1, static_cast<uint32_t>((centroids[item][axis] - axisMin) * scale));
+
+            binBounds[bin].expand(bounds[item]);
+            ++binCounts[bin];
+        }
+
+        std::array<float, BIN_COUNT - 1> leftArea;
+        std::array<uint32_t, BIN_COUNT - 1> leftCount;
+
+        AABB leftBounds;
+        uint32_t leftSum = 0;
+
+        for (uint32_t split = 0; split < BIN_COUNT - 1; ++split)
+        {
+            leftBounds.expand(binBounds[split]);
+            leftSum += binCounts[split];
+
+            leftArea[split] = surfaceArea(leftBounds);
+            leftCount[split] = leftSum;
+        }
+
+        AABB rightBounds;
+        uint32_t rightSum = 0;
+
+        for (uint32_t split = BIN_COUNT - 1; split > 0; --split)
+        {
+            rightBounds.expand(binBounds[split]);
+            rightSum += binCounts[split];
+
+            const float cost = leftArea[split - 1] * leftCount[split - 1] + surfaceArea(rightBounds) * rightSum;
+
+            if (cost < bestCost)
+            {
+                bestCost = cost;
+                bestAxis = axis;
+                bestSplit = split;
+            }
+        }
+    }
+
+    const float leafCost = surfaceArea(nodeBounds) * count;
+
+    if (bestAxis == -1 || (bestCost >= leafCost && count <= MAX_LEAF_SIZE))
+    {
+        return;
+    }
+
+    const float axisMin = centroidBounds.min[bestAxis];
+    const float scale = BIN_COUNT / (centroidBounds.max[bestAxis] - axisMin);
+
+    auto isLeft = [&](uint32_t item)
+    {
+        return std::min(BIN_COUNT - 1, static_cast<uint32_t>((centroids[item][bestAxis] - axisMin) * scale)) < bestSplit;
+    };
+
+    const auto middle = std::partition(m_items.begin() + first, m_items.begin() + first + count, isLeft);
+    const uint32_t leftCountFinal = static_cast<uint32_t>(middle - (m_items.begin() + first));
+
+    if (leftCountFinal == 0 || leftCountFinal == count)
+    {
+        return;
+    }
+
+    const uint32_t leftIdx = static_cast<uint32_t>(m_nodes.size());
+
+    m_nodes.push_back(Node { glm::vec3(0.0f), first, glm::vec3(0.0f), leftCountFinal });
+    m_nodes.push_back(Node { glm::vec3(0.0f), first + leftCountFinal, glm::vec3(0.0f), count - leftCountFinal });
+
+    m_nodes[nodeIdx].leftOrFirst = leftIdx;
+    m_nodes[nodeIdx].count = 0;
+
+    subdivide(leftIdx, depth + 1, bounds, centroids);
+    subdivide(leftIdx + 1, depth + 1, bounds, centroids);
+}
\ No newline at end of file
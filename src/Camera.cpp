@@ -1,5 +1,7 @@
 #include "Camera.hpp"
 
+#include <cmath>
+
 
 Camera::Camera(glm::vec3 position, glm::vec3 up, float yaw, float pitch)
     : m_front(glm::vec3(0.0f, 0.0f, -1.0f))
@@ -37,11 +39,22 @@ float Camera::getZoom() const
     return m_zoom;
 }
 
+float Camera::getProjectionScale(float viewportHeight) const
+{
+    // Pixels covered by one unit of length at unit distance from the eye.
+    return viewportHeight / (2.0f * std::tan(glm::radians(m_zoom) * 0.5f));
+}
+
 const glm::vec3& Camera::getPosition() const
 {
     return m_position;
 }
 
+const glm::vec3& Camera::getFront() const
+{
+    return m_front;
+}
+
 void Camera::processKeyboard(Movement direction, float deltaTime)
 {
     const float velocity = m_movementSpeed * deltaTime;
@@ -0,0 +1,95 @@
+#include "Frustum.hpp"
+
+#include <cmath>
+#include <limits>
+
+
+Frustum Frustum::fromMatrix(const glm::mat4& clip)
+{
+    auto row = [&clip](int idx) { return glm::vec4(clip[0][idx], clip[1][idx], clip[2][idx], clip[3][idx]); };
+
+    const glm::vec4 planes[6] =
+    {
+        row(3) + row(0),
+        row(3) - row(0),
+        row(3) + row(1),
+        row(3) - row(1),
+        row(3) + row(2),
+        row(3) - row(2)
+    };
+
+    Frustum frustum;
+
+    for (size_t idx = 0; idx < LANES; ++idx)
+    {
+        if (idx >= 6)
+        {
+            // Padding lanes never reject anything.
+            frustum.m_x[idx] = 0.0f;
+            frustum.m_y[idx] = 0.0f;
+            frustum.m_z[idx] = 0.0f;
+            frustum.m_w[idx] = std::numeric_limits<float>::max();
+            continue;
+        }
+
+        const glm::vec4& plane = planes[idx];
+        const float length = glm::length(glm::vec3(plane));
+
+        frustum.m_x[idx] = plane.x / length;
+        frustum.m_y[idx] = plane.y / length;
+        frustum.m_z[idx] = plane.z / length;
+        frustum.m_w[idx] = plane.w / length;
+    }
+
+    return frustum;
+}
+
+bool Frustum::intersects(const BoundingSphere& sphere) const
+{
+    bool inside = true;
+
+    for (size_t idx = 0; idx < LANES; ++idx)
+    {
+        const float distance = m_x[idx] * sphere.center.x + m_y[idx] * sphere.center.y + m_z[idx] * sphere.center.z + m_w[idx];
+        inside &= distance >= -sphere.radius;
+    }
+
+    return inside;
+}
+
+bool Frustum::intersects(const AABB& bounds) const
+{
+    const glm::vec3 center = bounds.getCenter();
+    const glm::vec3 extents = bounds.getExtents();
+
+    bool inside = true;
+
+    for (size_t idx = 0; idx < LANES; ++idx)
+    {
+        const float distance = m_x[idx] * center.x + m_y[idx] * center.y + m_z[idx] * center.z + m_w[idx];
+        const float radius = std::abs(m_x[idx]) * extents.x + std::abs(m_y[idx]) * extents.y + std::abs(m_z[idx]) * extents.z;
+
+        inside &= distance >= -radius;
+    }
+
+    return inside;
+}
+
+CullStats Frustum::cull(std::span<const BoundingSphere> spheres, std::span<const AABB> bounds, std::span<uint8_t> visible) const
+{
+    CullStats stats;
+
+    for (size_t idx = 0; idx < spheres.size(); ++idx)
+    {
+        // The sphere test is cheap but loose; meshes that pass it are refined
+        // with the box test.
+        const bool isVisible = intersects(spheres[idx]) && intersects(bounds[idx]);
+
+        visible[idx] = isVisible;
+
+        ++stats.tested;
+        stats.visible += isVisible;
+    }
+
+    return stats;
+}
\ No newline at end of file
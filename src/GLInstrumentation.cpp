@@ -0,0 +1,265 @@
+#include "GLInstrumentation.hpp"
+
+#ifdef GL_INSTRUMENTATION
+
+#include "Hash.hpp"
+#include "Logger.hpp"
+
+#include <array>
+#include <vector>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace
+{
+    struct CallStats
+    {
+        uint64_t calls = 0;
+        uint64_t redundant = 0;
+        uint64_t frameCalls = 0;
+        uint64_t peakFrameCalls = 0;
+
+        // Last value per binding point or uniform location.
+        std::unordered_map<uint64_t, uint64_t> lastValues;
+    };
+
+    struct State
+    {
+        std::unordered_map<std::string_view, CallStats> calls;
+        uint64_t frames = 0;
+        uint64_t lastFrameCalls = 0;
+        GLuint program = 0;
+        GLuint vertexArray = 0;
+        GLenum activeUnit = GL_TEXTURE0;
+    };
+
+    struct ForgetRule
+    {
+        std::string_view call;
+        std::array<std::string_view, 3> bindCalls;
+    };
+
+    constexpr std::array<ForgetRule, 5> FORGET_RULES
+    {
+        ForgetRule { "glDeleteBuffers", { "glBindBuffer", "glBindBufferBase", "glBindBufferRange" } },
+        ForgetRule { "glDeleteTextures", { "glBindTexture" } },
+        ForgetRule { "glDeleteVertexArrays", { "glBindVertexArray", "glBindBuffer" } },
+        ForgetRule { "glDeleteFramebuffers", { "glBindFramebuffer" } },
+        ForgetRule { "glDeleteRenderbuffers", { "glBindRenderbuffer" } }
+    };
+
+    constexpr std::array<std::string_view, 4> UNIFORM_CALLS { "glUniform1i", "glUniform1f", "glUniform3fv", "glUniformMatrix4fv" };
+
+    State& getState()
+    {
+        static State state;
+        return state;
+    }
+
+    CallStats& record(std::string_view call)
+    {
+        CallStats& stats = getState().calls[call];
+
+        ++stats.calls;
+        ++stats.frameCalls;
+
+        return stats;
+    }
+
+    void recordState(std::string_view call, uint64_t slot, uint64_t value)
+    {
+        CallStats& stats = record(call);
+        const auto [it, inserted] = stats.lastValues.try_emplace(slot, value);
+
+        if (inserted)
+        {
+            return;
+        }
+
+        if (it->second == value)
+        {
+            ++stats.redundant;
+        }
+        else
+        {
+            it->second = value;
+        }
+    }
+
+    uint64_t makeSlot(uint64_t high, uint64_t low)
+    {
+        return (high << 32) | (low & 0xFFFFFFFF);
+    }
+
+    double perFrame(uint64_t value, uint64_t frames)
+    {
+        return static_cast<double>(value) / static_cast<double>(frames);
+    }
+}
+
+
+void GLInstrumentation::count(std::string_view call)
+{
+    record(call);
+}
+
+void GLInstrumentation::useProgram(GLuint program)
+{
+    recordState("glUseProgram", 0, program);
+    getState().program = program;
+}
+
+void GLInstrumentation::bindVertexArray(GLuint vertexArray)
+{
+    recordState("glBindVertexArray", 0, vertexArray);
+    getState().vertexArray = vertexArray;
+}
+
+void GLInstrumentation::bindBuffer(GLenum target, GLuint buffer)
+{
+    // The element array binding is part of the vertex array state.
+    const uint64_t owner = target == GL_ELEMENT_ARRAY_BUFFER ? getState().vertexArray : 0;
+    recordState("glBindBuffer", makeSlot(owner, target), buffer);
+}
+
+void GLInstrumentation::bindBufferRange(std::string_view call, GLenum target, GLuint index, GLuint buffer, GLintptr offset, GLsizeiptr size)
+{
+    const std::array<uint64_t, 3> range { buffer, static_cast<uint64_t>(offset), static_cast<uint64_t>(size) };
+    recordState(call, makeSlot(target, index), fnv1a(range.data(), sizeof(range)));
+
+    // Indexed binds also replace the generic binding of the target.
+    getState().calls["glBindBuffer"].lastValues[makeSlot(0, target)] = buffer;
+}
+
+void GLInstrumentation::activeTexture(GLenum unit)
+{
+    recordState("glActiveTexture", 0, unit);
+    getState().activeUnit = unit;
+}
+
+void GLInstrumentation::bindTexture(GLenum target, GLuint texture)
+{
+    recordState("glBindTexture", makeSlot(getState().activeUnit - GL_TEXTURE0, target), texture);
+}
+
+void GLInstrumentation::bindFramebuffer(GLenum target, GLuint framebuffer)
+{
+    recordState("glBindFramebuffer", target, framebuffer);
+}
+
+void GLInstrumentation::bindRenderbuffer(GLenum target, GLuint renderbuffer)
+{
+    recordState("glBindRenderbuffer", target, renderbuffer);
+}
+
+void GLInstrumentation::uniform(std::string_view call, GLint location, const void* data, size_t size)
+{
+    recordState(call, makeSlot(getState().program, static_cast<uint32_t>(location)), fnv1a(data, size));
+}
+
+void GLInstrumentation::forget(std::string_view call)
+{
+    record(call);
+
+    for (const ForgetRule& rule : FORGET_RULES)
+    {
+        if (rule.call != call)
+        {
+            continue;
+        }
+
+        for (const std::string_view bindCall : rule.bindCalls)
+        {
+            if (!bindCall.empty())
+            {
+                getState().calls[bindCall].lastValues.clear();
+            }
+        }
+    }
+}
+
+void GLInstrumentation::forgetProgram(std::string_view call, GLuint program)
+{
+    record(call);
+
+    for (const std::string_view uniformCall : UNIFORM_CALLS)
+    {
+        std::erase_if(getState().calls[uniformCall].lastValues, [program](const auto& entry) { return (entry.first >> 32) == program; });
+    }
+
+    getState().calls["glUseProgram"].lastValues.clear();
+}
+
+void GLInstrumentation::endFrame()
+{
+    State& state = getState();
+
+    ++state.frames;
+    state.lastFrameCalls = 0;
+
+    for (auto& [call, stats] : state.calls)
+    {
+        state.lastFrameCalls += stats.frameCalls;
+        stats.peakFrameCalls = std::max(stats.peakFrameCalls, stats.frameCalls);
+        stats.frameCalls = 0;
+    }
+}
+
+uint64_t GLInstrumentation::getLastFrameCalls()
+{
+    return getState().lastFrameCalls;
+}
+
+void GLInstrumentation::report(size_t topCount)
+{
+    const State& state = getState();
+
+    if (state.frames == 0)
+    {
+        return;
+    }
+
+    std::vector<std::pair<std::string_view, const CallStats*>> calls;
+    uint64_t totalCalls = 0;
+    uint64_t totalRedundant = 0;
+
+    for (const auto& [call, stats] : state.calls)
+    {
+        if (stats.calls > 0)
+        {
+            calls.emplace_back(call, &stats);
+            totalCalls += stats.calls;
+            totalRedundant += stats.redundant;
+        }
+    }
+
+    logInfo("GL calls over {} frames: {:.1f} per frame, {:.1f} redundant", state.frames, perFrame(totalCalls, state.frames), perFrame(totalRedundant, state.frames));
+
+    std::sort(calls.begin(), calls.end(), [](const auto& lhs, const auto& rhs) { return lhs.second->calls > rhs.second->calls; });
+
+    for (size_t idx = 0; idx < std::min(topCount, calls.size()); ++idx)
+    {
+        const auto& [call, stats] = calls[idx];
+        logInfo("  {:<36} {:>10.1f} per frame, peak {}", call, perFrame(stats->calls, state.frames), stats->peakFrameCalls);
+    }
+
+    std::sort(calls.begin(), calls.end(), [](const auto& lhs, const auto& rhs) { return lhs.second->redundant > rhs.second->redundant; });
+
+    if (calls.empty() || calls.front().second->redundant == 0)
+    {
+        return;
+    }
+
+    logInfo("Redundant GL calls:");
+
+    for (size_t idx = 0; idx < std::min(topCount, calls.size()) && calls[idx].second->redundant > 0; ++idx)
+    {
+        const auto& [call, stats] = calls[idx];
+        const double share = 100.0 * static_cast<double>(stats->redundant) / static_cast<double>(stats->calls);
+
+        logInfo("  {:<36} {:>10.1f} per frame ({:.0f}% of its calls)", call, perFrame(stats->redundant, state.frames), share);
+    }
+}
+
+#endif
\ No newline at end of file
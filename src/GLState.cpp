@@ -0,0 +1,117 @@
+#include "GLState.hpp"
+
+#include <GL/glew.h>
+
+
+GLState::State GLState::s_state;
+
+void GLState::useProgram(uint32_t program)
+{
+    if (s_state.program == program)
+    {
+        return;
+    }
+
+    glUseProgram(program);
+    s_state.program = program;
+}
+
+void GLState::bindVertexArray(uint32_t vertexArray)
+{
+    if (s_state.vertexArray == vertexArray)
+    {
+        return;
+    }
+
+    glBindVertexArray(vertexArray);
+    s_state.vertexArray = vertexArray;
+}
+
+void GLState::bindTexture(uint32_t unit, uint32_t texture)
+{
+    if (s_state.textures[unit] == texture)
+    {
+        return;
+    }
+
+    if (s_state.activeUnit != unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        s_state.activeUnit = unit;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, texture);
+    s_state.textures[unit] = texture;
+}
+
+void GLState::bindUniformBuffer(uint32_t binding, uint32_t buffer, size_t offset, size_t size)
+{
+    UniformRange& bound = s_state.uniformBuffers[binding];
+
+    if (bound.buffer == buffer && bound.offset == offset && bound.size == size)
+    {
+        return;
+    }
+
+    glBindBufferRange(GL_UNIFORM_BUFFER, binding, buffer, static_cast<GLintptr>(offset), static_cast<GLsizeiptr>(size));
+    bound = UniformRange { buffer, offset, size };
+}
+
+void GLState::forgetProgram(uint32_t program)
+{
+    if (s_state.program == program)
+    {
+        s_state.program = 0;
+    }
+}
+
+void GLState::forgetVertexArray(uint32_t vertexArray)
+{
+    if (s_state.vertexArray == vertexArray)
+    {
+        s_state.vertexArray = 0;
+    }
+}
+
+void GLState::forgetTexture(uint32_t texture)
+{
+    for (uint32_t& bound : s_state.textures)
+    {
+        if (bound == texture)
+        {
+            bound = 0;
+        }
+    }
+}
+
+void GLState::forgetUniformBuffer(uint32_t buffer)
+{
+    for (UniformRange& bound : s_state.uniformBuffers)
+    {
+        if (bound.buffer == buffer)
+        {
+            bound = UniformRange {};
+        }
+    }
+}
+
+void GLState::invalidate()
+{
+    glUseProgram(0);
+    glBindVertexArray(0);
+
+    for (uint32_t unit = 0; unit < TEXTURE_UNITS; ++unit)
+    {
+        glActiveTexture(GL_TEXTURE0 + unit);
+        glBindTexture(GL_TEXTURE_2D, 0);
+    }
+
+    glActiveTexture(GL_TEXTURE0);
+
+    for (uint32_t binding = 0; binding < UNIFORM_BINDINGS; ++binding)
+    {
+        glBindBufferBase(GL_UNIFORM_BUFFER, binding, 0);
+    }
+
+    s_state = State {};
+}
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include "GeometryArena.hpp"
+
+#include "Mesh.hpp"
+#include "Logger.hpp"
+#include "GLState.hpp"
+
+#include <GL/glew.h>
+
+#include <algorithm>
+
+
+namespace
+{
+    // Converts vertices straight into the mapped buffer range instead of
+    // going through a temporary array.
+    template <typename Target, typename Source, typename Convert>
+    void convertVertices(uint32_t buffer, size_t firstVertex, std::span<const Source> source, Convert convert)
+    {
+        if (source.empty())
+        {
+            return;
+        }
+
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+
+        const GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
+        Target* target = static_cast<Target*>(glMapBufferRange(GL_COPY_WRITE_BUFFER, firstVertex * sizeof(Target), source.size() * sizeof(Target), access));
+
+        if (target == nullptr)
+        {
+            logError("Failed to map geometry arena vertex buffer");
+            return;
+        }
+
+        for (size_t idx = 0; idx < source.size(); ++idx)
+        {
+            target[idx] = convert(source[idx]);
+        }
+
+        if (glUnmapBuffer(GL_COPY_WRITE_BUFFER) != GL_TRUE)
+        {
+            logWarning("Geometry arena vertex data was lost while mapped");
+        }
+    }
+
+    uint32_t createBuffer(size_t size)
+    {
+        uint32_t buffer;
+        glGenBuffers(1, &buffer);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, buffer);
+        glBufferData(GL_COPY_WRITE_BUFFER, size, nullptr, GL_STATIC_DRAW);
+
+        return buffer;
+    }
+
+    uint32_t moveBuffer(uint32_t buffer, size_t usedSize, size_t newSize)
+    {
+        const uint32_t newBuffer = createBuffer(newSize);
+
+        if (usedSize > 0)
+        {
+            glBindBuffer(GL_COPY_READ_BUFFER, buffer);
+            glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, usedSize);
+        }
+
+        glDeleteBuffers(1, &buffer);
+
+        return newBuffer;
+    }
+}
+
+
+std::shared_ptr<GeometryArena> GeometryArena::create(size_t vertexCapacity, size_t indexCapacity, VertexFormat format, const VertexQuantization& quantization)
+{
+    std::shared_ptr<GeometryArena> arena(new GeometryArena());
+
+    arena->m_format = format;
+    arena->m_quantization = quantization;
+
+    glGenVertexArrays(1, &arena->m_vertexArray);
+    arena->reallocate(std::max<size_t>(vertexCapacity, 1), std::max<size_t>(indexCapacity, 1));
+
+    return arena;
+}
+
+GeometryArena::~GeometryArena()
+{
+    GLState::forgetVertexArray(m_vertexArray);
+
+    glDeleteVertexArrays(1, &m_vertexArray);
+    glDeleteBuffers(1, &m_vertexBuffer);
+    glDeleteBuffers(1, &m_elementBuffer);
+}
+
+GeometryArena::Range GeometryArena::allocate(std::span<const Vertex> vertices, std::span<const uint32_t> indices)
+{
+    const Range range = reserve(vertices.size(), indices);
+
+    if (m_format == VertexFormat::Float)
+    {
+        writeVertices(range, vertices.data(), vertices.size_bytes());
+    }
+    else
+    {
+        convertVertices<PackedVertex>(m_vertexBuffer, range.baseVertex, vertices, [this](const Vertex& vertex) { return packVertex(vertex, m_quantization); });
+    }
+
+    return range;
+}
+
+GeometryArena::Range GeometryArena::allocate(std::span<const PackedVertex> vertices, std::span<const uint32_t> indices)
+{
+    const Range range = reserve(vertices.size(), indices);
+
+    if (m_format == VertexFormat::Packed)
+    {
+        writeVertices(range, vertices.data(), vertices.size_bytes());
+    }
+    else
+    {
+        convertVertices<Vertex>(m_vertexBuffer, range.baseVertex, vertices, [this](const PackedVertex& vertex) { return unpackVertex(vertex, m_quantization); });
+    }
+
+    return range;
+}
+
+VertexFormat GeometryArena::getFormat() const
+{
+    return m_format;
+}
+
+const VertexQuantization& GeometryArena::getQuantization() const
+{
+    return m_quantization;
+}
+
+uint32_t GeometryArena::getVertexArray() const
+{
+    return m_vertexArray;
+}
+
+uint32_t GeometryArena::getVertexBuffer() const
+{
+    return m_vertexBuffer;
+}
+
+uint32_t GeometryArena::getElementBuffer() const
+{
+    return m_elementBuffer;
+}
+
+void GeometryArena::setupVertexAttributes() const
+{
+    if (m_format == VertexFormat::Packed)
+    {
+        // Positions come out in [0, 1] and are dequantized by the shader;
+        // normals are the two octahedral components.
+        glEnableVertexAttribArray(0);
+        glVertexAttribPointer(0, 3, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, position)));
+        glEnableVertexAttribArray(1);
+        glVertexAttribPointer(1, 2, GL_SHORT, GL_TRUE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, normal)));
+        glEnableVertexAttribArray(2);
+        glVertexAttribPointer(2, 2, GL_HALF_FLOAT, GL_FALSE, sizeof(PackedVertex), reinterpret_cast<void*>(offsetof(PackedVertex, texCoords)));
+
+        return;
+    }
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texCoords)));
+}
+
+GeometryArena::Range GeometryArena::reserve(size_t vertexCount, std::span<const uint32_t> indices)
+{
+    if (m_vertexCount + vertexCount > m_vertexCapacity || m_indexCount + indices.size() > m_indexCapacity)
+    {
+        reallocate(std::max(m_vertexCapacity * 2, m_vertexCount + vertexCount), std::max(m_indexCapacity * 2, m_indexCount + indices.size()));
+    }
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_elementBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, m_indexCount * sizeof(uint32_t), indices.size_bytes(), indices.data());
+
+    const Range range { static_cast<int32_t>(m_vertexCount), static_cast<uint32_t>(m_indexCount), static_cast<uint32_t>(indices.size()) };
+
+    m_vertexCount += vertexCount;
+    m_indexCount += indices.size();
+
+    return range;
+}
+
+void GeometryArena::writeVertices(const Range& range, const void* vertices, size_t size)
+{
+    glBindBuffer(GL_COPY_WRITE_BUFFER, m_vertexBuffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, range.baseVertex * getVertexStride(m_format), size, vertices);
+}
+
+void GeometryArena::reallocate(size_t vertexCapacity, size_t indexCapacity)
+{
+    const size_t stride = getVertexStride(m_format);
+
+    m_vertexBuffer = moveBuffer(m_vertexBuffer, m_vertexCount * stride, vertexCapacity * stride);
+    m_elementBuffer = moveBuffer(m_elementBuffer, m_indexCount * sizeof(uint32_t), indexCapacity * sizeof(uint32_t));
+
+    m_vertexCapacity = vertexCapacity;
+    m_indexCapacity = indexCapacity;
+
+    GLState::bindVertexArray(m_vertexArray);
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_vertexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_elementBuffer);
+    setupVertexAttributes();
+
+    GLState::bindVertexArray(0);
+}
\ No newline at end of file
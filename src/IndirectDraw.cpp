@@ -0,0 +1,124 @@
+#include "IndirectDraw.hpp"
+
+#include "GLState.hpp"
+#include "RenderStats.hpp"
+
+#include <GL/glew.h>
+
+#include <cstring>
+
+
+bool IndirectDrawBuffer::isSupported()
+{
+    return GLEW_VERSION_4_3 || GLEW_ARB_multi_draw_indirect;
+}
+
+IndirectDrawBuffer IndirectDrawBuffer::create()
+{
+    IndirectDrawBuffer self;
+    glGenBuffers(1, &self.m_buffer);
+
+    return self;
+}
+
+IndirectDrawBuffer::~IndirectDrawBuffer()
+{
+    glDeleteBuffers(1, &m_buffer);
+}
+
+IndirectDrawBuffer::IndirectDrawBuffer(IndirectDrawBuffer&& other) noexcept
+{
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_capacity, other.m_capacity);
+    std::swap(m_commands, other.m_commands);
+    std::swap(m_uploaded, other.m_uploaded);
+    std::swap(m_buckets, other.m_buckets);
+}
+
+IndirectDrawBuffer& IndirectDrawBuffer::operator=(IndirectDrawBuffer&& other) noexcept
+{
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_capacity, other.m_capacity);
+    std::swap(m_commands, other.m_commands);
+    std::swap(m_uploaded, other.m_uploaded);
+    std::swap(m_buckets, other.m_buckets);
+
+    return *this;
+}
+
+void IndirectDrawBuffer::draw(const Shader& shader, const std::vector<Mesh>& meshes, std::span<const uint32_t> order, std::span<const uint32_t> lods)
+{
+    m_commands.clear();
+    m_buckets.clear();
+
+    for (const uint32_t idx : order)
+    {
+        const Mesh& mesh = meshes[idx];
+        const GeometryArena::Range range = mesh.getLodRange(lods.empty() ? 0 : lods[idx]);
+
+        const bool sameBucket = !m_buckets.empty()
+            && meshes[m_buckets.back().mesh].getVertexArray() == mesh.getVertexArray()
+            && meshes[m_buckets.back().mesh].getTextureKey() == mesh.getTextureKey();
+
+        if (!sameBucket)
+        {
+            m_buckets.push_back({ idx, static_cast<uint32_t>(m_commands.size()), 0 });
+        }
+
+        m_commands.push_back({ range.indexCount, 1, range.firstIndex, range.baseVertex, 0 });
+        ++m_buckets.back().commandCount;
+    }
+
+    if (m_commands.empty())
+    {
+        return;
+    }
+
+    upload();
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_buffer);
+
+    for (const Bucket& bucket : m_buckets)
+    {
+        const Mesh& mesh = meshes[bucket.mesh];
+        const size_t offset = bucket.firstCommand * sizeof(DrawElementsIndirectCommand);
+
+        mesh.bindMaterial(shader);
+        GLState::bindVertexArray(mesh.getVertexArray());
+
+        glMultiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, reinterpret_cast<void*>(offset), bucket.commandCount, 0);
+
+        uint64_t triangles = 0;
+
+        for (uint32_t command = 0; command < bucket.commandCount; ++command)
+        {
+            triangles += m_commands[bucket.firstCommand + command].count / 3;
+        }
+
+        RenderStats::countDraw(bucket.commandCount, triangles);
+    }
+}
+
+void IndirectDrawBuffer::upload()
+{
+    const size_t size = m_commands.size() * sizeof(DrawElementsIndirectCommand);
+
+    if (m_uploaded.size() == m_commands.size() && std::memcmp(m_uploaded.data(), m_commands.data(), size) == 0)
+    {
+        return;
+    }
+
+    glBindBuffer(GL_DRAW_INDIRECT_BUFFER, m_buffer);
+
+    if (size > m_capacity)
+    {
+        glBufferData(GL_DRAW_INDIRECT_BUFFER, size, m_commands.data(), GL_DYNAMIC_DRAW);
+        m_capacity = size;
+    }
+    else
+    {
+        glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, size, m_commands.data());
+    }
+
+    m_uploaded = m_commands;
+}
\ No newline at end of file
@@ -0,0 +1,139 @@
+#include "InstancedMesh.hpp"
+
+#include "GLState.hpp"
+#include "RenderStats.hpp"
+
+#include <GL/glew.h>
+
+#include <bit>
+
+
+namespace
+{
+    void stream(uint32_t buffer, size_t& capacity, const void* data, size_t size)
+    {
+        glBindBuffer(GL_ARRAY_BUFFER, buffer);
+
+        if (size > capacity)
+        {
+            capacity = std::bit_ceil(size);
+        }
+
+        // Orphan the previous storage so the driver does not wait for draws
+        // still reading last frame's instances.
+        glBufferData(GL_ARRAY_BUFFER, capacity, nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_ARRAY_BUFFER, 0, size, data);
+    }
+}
+
+
+InstancedMesh InstancedMesh::create(const Mesh& mesh)
+{
+    InstancedMesh self;
+
+    self.m_mesh = &mesh;
+
+    glGenVertexArrays(1, &self.m_vertexArray);
+    glGenBuffers(1, &self.m_transformBuffer);
+    glGenBuffers(1, &self.m_colorBuffer);
+
+    self.setupVertexArray();
+
+    return self;
+}
+
+InstancedMesh::~InstancedMesh()
+{
+    GLState::forgetVertexArray(m_vertexArray);
+
+    glDeleteVertexArrays(1, &m_vertexArray);
+    glDeleteBuffers(1, &m_transformBuffer);
+    glDeleteBuffers(1, &m_colorBuffer);
+}
+
+InstancedMesh::InstancedMesh(InstancedMesh&& other) noexcept
+{
+    std::swap(m_mesh, other.m_mesh);
+    std::swap(m_vertexArray, other.m_vertexArray);
+    std::swap(m_arenaBuffer, other.m_arenaBuffer);
+    std::swap(m_transformBuffer, other.m_transformBuffer);
+    std::swap(m_transformCapacity, other.m_transformCapacity);
+    std::swap(m_colorBuffer, other.m_colorBuffer);
+    std::swap(m_colorCapacity, other.m_colorCapacity);
+}
+
+InstancedMesh& InstancedMesh::operator=(InstancedMesh&& other) noexcept
+{
+    std::swap(m_mesh, other.m_mesh);
+    std::swap(m_vertexArray, other.m_vertexArray);
+    std::swap(m_arenaBuffer, other.m_arenaBuffer);
+    std::swap(m_transformBuffer, other.m_transformBuffer);
+    std::swap(m_transformCapacity, other.m_transformCapacity);
+    std::swap(m_colorBuffer, other.m_colorBuffer);
+    std::swap(m_colorCapacity, other.m_colorCapacity);
+
+    return *this;
+}
+
+void InstancedMesh::draw(const Shader& shader, std::span<const glm::mat4> transforms, std::span<const glm::vec4> colors)
+{
+    if (transforms.empty())
+    {
+        return;
+    }
+
+    // The arena reallocates its buffers when it grows; follow it.
+    if (m_arenaBuffer != m_mesh->getArena().getVertexBuffer())
+    {
+        setupVertexArray();
+    }
+
+    GLState::bindVertexArray(m_vertexArray);
+
+    stream(m_transformBuffer, m_transformCapacity, transforms.data(), transforms.size_bytes());
+
+    if (colors.size() >= transforms.size())
+    {
+        stream(m_colorBuffer, m_colorCapacity, colors.data(), transforms.size() * sizeof(glm::vec4));
+        glEnableVertexAttribArray(COLOR_ATTRIBUTE);
+    }
+    else
+    {
+        glDisableVertexAttribArray(COLOR_ATTRIBUTE);
+        glVertexAttrib4f(COLOR_ATTRIBUTE, 1.0f, 1.0f, 1.0f, 1.0f);
+    }
+
+    m_mesh->bindMaterial(shader);
+
+    const GeometryArena::Range range = m_mesh->getLodRange(0);
+    glDrawElementsInstancedBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(range.firstIndex * sizeof(uint32_t)), transforms.size(), range.baseVertex);
+    RenderStats::countDraw(1, static_cast<uint64_t>(range.indexCount / 3) * transforms.size());
+}
+
+void InstancedMesh::setupVertexArray()
+{
+    const GeometryArena& arena = m_mesh->getArena();
+
+    GLState::bindVertexArray(m_vertexArray);
+
+    glBindBuffer(GL_ARRAY_BUFFER, arena.getVertexBuffer());
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, arena.getElementBuffer());
+    arena.setupVertexAttributes();
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_transformBuffer);
+
+    for (uint32_t column = 0; column < 4; ++column)
+    {
+        const uint32_t attribute = TRANSFORM_ATTRIBUTE + column;
+
+        glEnableVertexAttribArray(attribute);
+        glVertexAttribPointer(attribute, 4, GL_FLOAT, GL_FALSE, sizeof(glm::mat4), reinterpret_cast<void*>(column * sizeof(glm::vec4)));
+        glVertexAttribDivisor(attribute, 1);
+    }
+
+    glBindBuffer(GL_ARRAY_BUFFER, m_colorBuffer);
+    glVertexAttribPointer(COLOR_ATTRIBUTE, 4, GL_FLOAT, GL_FALSE, sizeof(glm::vec4), nullptr);
+    glVertexAttribDivisor(COLOR_ATTRIBUTE, 1);
+
+    m_arenaBuffer = arena.getVertexBuffer();
+}
\ No newline at end of file
@@ -0,0 +1,359 @@
+#include "Ktx2.hpp"
+
+#include "Logger.hpp"
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+#include <bit>
+#include <span>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    constexpr std::string_view ORIENTATION_KEY = "KTXorientation";
+
+    // Data format descriptor values (Khronos Data Format Specification).
+    constexpr uint32_t DFD_VERSION = 2;
+    constexpr uint8_t DFD_PRIMARIES_BT709 = 1;
+    constexpr uint8_t DFD_TRANSFER_LINEAR = 1;
+    constexpr uint8_t DFD_TRANSFER_SRGB = 2;
+    constexpr uint8_t DFD_CHANNEL_LINEAR = 0x10;
+    constexpr uint8_t DFD_CHANNEL_ALPHA = 15;
+
+    struct FileHeader
+    {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+
+    static_assert(sizeof(FileHeader) == 80);
+
+    struct LevelIndex
+    {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    struct FormatInfo
+    {
+        CompressedFormat format;
+        uint32_t blockSize;
+        uint8_t colorModel;
+        bool srgb;
+        uint32_t sampleCount;
+        uint8_t channels[2];
+    };
+
+    constexpr FormatInfo FORMATS[] =
+    {
+        { CompressedFormat::Bc1, 8, 128, false, 1, { 0 } },
+        { CompressedFormat::Bc1Srgb, 8, 128, true, 1, { 0 } },
+        { CompressedFormat::Bc1Alpha, 8, 128, false, 1, { 1 } },
+        { CompressedFormat::Bc1AlphaSrgb, 8, 128, true, 1, { 1 } },
+        { CompressedFormat::Bc3, 16, 130, false, 2, { DFD_CHANNEL_ALPHA, 0 } },
+        { CompressedFormat::Bc3Srgb, 16, 130, true, 2, { DFD_CHANNEL_ALPHA, 0 } },
+        { CompressedFormat::Bc5, 16, 132, false, 2, { 0, 1 } },
+        { CompressedFormat::Bc7, 16, 134, false, 1, { 0 } },
+        { CompressedFormat::Bc7Srgb, 16, 134, true, 1, { 0 } },
+        { CompressedFormat::Etc2, 8, 161, false, 1, { 2 } },
+        { CompressedFormat::Etc2Srgb, 8, 161, true, 1, { 2 } },
+        { CompressedFormat::Etc2Alpha, 16, 161, false, 2, { DFD_CHANNEL_ALPHA, 2 } },
+        { CompressedFormat::Etc2AlphaSrgb, 16, 161, true, 2, { DFD_CHANNEL_ALPHA, 2 } }
+    };
+
+    const FormatInfo* findFormat(CompressedFormat format)
+    {
+        auto it = std::find_if(std::begin(FORMATS), std::end(FORMATS), [format](const FormatInfo& info) { return info.format == format; });
+        return it != std::end(FORMATS) ? &*it : nullptr;
+    }
+
+    template<typename T>
+    void append(std::vector<uint8_t>& bytes, const T& value)
+    {
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(&value);
+        bytes.insert(bytes.end(), data, data + sizeof(T));
+    }
+
+    void padTo(std::vector<uint8_t>& bytes, size_t alignment)
+    {
+        bytes.resize((bytes.size() + alignment - 1) / alignment * alignment, 0);
+    }
+
+    // A basic descriptor block with one sample per block half (or one for the
+    // whole block).
+    std::vector<uint8_t> createDataFormatDescriptor(const FormatInfo& info)
+    {
+        const uint32_t blockSize = 24 + 16 * info.sampleCount;
+        const uint32_t sampleBits = info.blockSize * 8 / info.sampleCount;
+        const uint8_t transfer = info.srgb ? DFD_TRANSFER_SRGB : DFD_TRANSFER_LINEAR;
+
+        std::vector<uint8_t> bytes;
+
+        append(bytes, uint32_t(4 + blockSize));
+        append(bytes, uint32_t(0));
+        append(bytes, uint32_t(DFD_VERSION | blockSize << 16));
+        append(bytes, uint32_t(info.colorModel | DFD_PRIMARIES_BT709 << 8 | transfer << 16));
+        append(bytes, uint32_t(3 | 3 << 8));
+        append(bytes, uint32_t(info.blockSize));
+        append(bytes, uint32_t(0));
+
+        for (uint32_t idx = 0; idx < info.sampleCount; ++idx)
+        {
+            uint8_t channel = info.channels[idx];
+
+            if (info.srgb && channel == DFD_CHANNEL_ALPHA)
+            {
+                channel |= DFD_CHANNEL_LINEAR;
+            }
+
+            append(bytes, uint32_t(idx * sampleBits | (sampleBits - 1) << 16 | uint32_t(channel) << 24));
+            append(bytes, uint32_t(0));
+            append(bytes, uint32_t(0));
+            append(bytes, uint32_t(0xFFFFFFFF));
+        }
+
+        return bytes;
+    }
+
+    bool readFile(std::string_view path, std::vector<uint8_t>& bytes)
+    {
+        FILE* file = std::fopen(std::string(path).c_str(), "rb");
+
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        bool result = std::fseek(file, 0, SEEK_END) == 0;
+        const long size = result ? std::ftell(file) : -1;
+
+        result = size >= 0 && std::fseek(file, 0, SEEK_SET) == 0;
+
+        if (result)
+        {
+            bytes.resize(size);
+            result = size == 0 || std::fread(bytes.data(), size, 1, file) == 1;
+        }
+
+        std::fclose(file);
+
+        return result;
+    }
+
+    bool readOrientation(std::span<const uint8_t> kvd, bool& flippedVertically)
+    {
+        size_t offset = 0;
+
+        while (offset + sizeof(uint32_t) <= kvd.size())
+        {
+            uint32_t length;
+            std::memcpy(&length, kvd.data() + offset, sizeof(length));
+            offset += sizeof(length);
+
+            if (length > kvd.size() - offset)
+            {
+                return false;
+            }
+
+            const std::string_view entry(reinterpret_cast<const char*>(kvd.data() + offset), length);
+            const size_t separator = entry.find('\0');
+
+            if (separator != std::string_view::npos && entry.substr(0, separator) == ORIENTATION_KEY)
+            {
+                const std::string_view value = entry.substr(separator + 1);
+                flippedVertically = value.size() >= 2 && value[1] == 'u';
+            }
+
+            offset += (length + 3) & ~3u;
+        }
+
+        return true;
+    }
+}
+
+
+size_t getBlockSize(CompressedFormat format)
+{
+    const FormatInfo* info = findFormat(format);
+    return info != nullptr ? info->blockSize : 0;
+}
+
+size_t getCompressedSize(CompressedFormat format, uint32_t width, uint32_t height)
+{
+    return static_cast<size_t>((width + 3) / 4) * ((height + 3) / 4) * getBlockSize(format);
+}
+
+std::optional<Ktx2Image> readKtx2(std::string_view path)
+{
+    Ktx2Image image;
+
+    if (!readFile(path, image.data))
+    {
+        return std::nullopt;
+    }
+
+    FileHeader header;
+
+    if (image.data.size() < sizeof(header))
+    {
+        logWarning("Invalid KTX2 file: {}", path);
+        return std::nullopt;
+    }
+
+    std::memcpy(&header, image.data.data(), sizeof(header));
+
+    image.format = static_cast<CompressedFormat>(header.vkFormat);
+    image.width = header.pixelWidth;
+    image.height = header.pixelHeight;
+    image.flippedVertically = false;
+
+    const bool is2D = header.pixelHeight > 0 && header.pixelDepth == 0 && header.layerCount == 0 && header.faceCount == 1;
+    const uint32_t maxLevelCount = std::bit_width(std::max(header.pixelWidth, header.pixelHeight));
+
+    if (std::memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0 || !is2D)
+    {
+        logWarning("Invalid KTX2 file: {}", path);
+        return std::nullopt;
+    }
+
+    if (getBlockSize(image.format) == 0 || header.supercompressionScheme != 0)
+    {
+        logWarning("Unsupported KTX2 format {} in: {}", header.vkFormat, path);
+        return std::nullopt;
+    }
+
+    const size_t indexEnd = sizeof(header) + static_cast<size_t>(header.levelCount) * sizeof(LevelIndex);
+    const size_t kvdEnd = static_cast<size_t>(header.kvdByteOffset) + header.kvdByteLength;
+
+    if (header.levelCount == 0 || header.levelCount > maxLevelCount || indexEnd > image.data.size() || kvdEnd > image.data.size())
+    {
+        logWarning("Invalid KTX2 file: {}", path);
+        return std::nullopt;
+    }
+
+    if (!readOrientation(std::span(image.data).subspan(header.kvdByteOffset, header.kvdByteLength), image.flippedVertically))
+    {
+        logWarning("Invalid KTX2 file: {}", path);
+        return std::nullopt;
+    }
+
+    image.levels.reserve(header.levelCount);
+
+    for (uint32_t level = 0; level < header.levelCount; ++level)
+    {
+        LevelIndex index;
+        std::memcpy(&index, image.data.data() + sizeof(header) + level * sizeof(LevelIndex), sizeof(index));
+
+        const uint32_t width = std::max(1u, image.width >> level);
+        const uint32_t height = std::max(1u, image.height >> level);
+
+        if (index.byteOffset > image.data.size() || index.byteLength > image.data.size() - index.byteOffset ||
+            index.byteLength != getCompressedSize(image.format, width, height))
+        {
+            logWarning("Invalid KTX2 file: {}", path);
+            return std::nullopt;
+        }
+
+        image.levels.push_back({ static_cast<size_t>(index.byteOffset), static_cast<size_t>(index.byteLength), width, height });
+    }
+
+    return std::make_optional(std::move(image));
+}
+
+bool writeKtx2(std::string_view path, const Ktx2Image& image)
+{
+    const FormatInfo* info = findFormat(image.format);
+
+    if (info == nullptr || image.levels.empty())
+    {
+        return false;
+    }
+
+    const std::vector<uint8_t> dfd = createDataFormatDescriptor(*info);
+
+    std::vector<uint8_t> kvd;
+    const std::string_view orientation = image.flippedVertically ? "ru" : "rd";
+
+    append(kvd, uint32_t(ORIENTATION_KEY.size() + 1 + orientation.size() + 1));
+    kvd.insert(kvd.end(), ORIENTATION_KEY.begin(), ORIENTATION_KEY.end());
+    kvd.push_back(0);
+    kvd.insert(kvd.end(), orientation.begin(), orientation.end());
+    kvd.push_back(0);
+    padTo(kvd, 4);
+
+    FileHeader header;
+    std::memcpy(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    header.vkFormat = static_cast<uint32_t>(image.format);
+    header.typeSize = 1;
+    header.pixelWidth = image.width;
+    header.pixelHeight = image.height;
+    header.pixelDepth = 0;
+    header.layerCount = 0;
+    header.faceCount = 1;
+    header.levelCount = static_cast<uint32_t>(image.levels.size());
+    header.supercompressionScheme = 0;
+    header.dfdByteOffset = static_cast<uint32_t>(sizeof(header) + image.levels.size() * sizeof(LevelIndex));
+    header.dfdByteLength = static_cast<uint32_t>(dfd.size());
+    header.kvdByteOffset = header.dfdByteOffset + header.dfdByteLength;
+    header.kvdByteLength = static_cast<uint32_t>(kvd.size());
+    header.sgdByteOffset = 0;
+    header.sgdByteLength = 0;
+
+    std::vector<uint8_t> bytes;
+    append(bytes, header);
+    bytes.resize(header.dfdByteOffset);
+    bytes.insert(bytes.end(), dfd.begin(), dfd.end());
+    bytes.insert(bytes.end(), kvd.begin(), kvd.end());
+
+    // Mip levels are stored smallest first, each aligned to a block.
+    for (size_t level = image.levels.size(); level-- > 0;)
+    {
+        const Ktx2Image::Level& source = image.levels[level];
+
+        padTo(bytes, info->blockSize);
+
+        const LevelIndex index { bytes.size(), source.size, source.size };
+        std::memcpy(bytes.data() + sizeof(header) + level * sizeof(LevelIndex), &index, sizeof(index));
+
+        bytes.insert(bytes.end(), image.data.begin() + source.offset, image.data.begin() + source.offset + source.size);
+    }
+
+    const std::string temporaryPath = std::string(path) + ".tmp";
+    FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        logWarning("Failed to create KTX2 file: {}", path);
+        return false;
+    }
+
+    bool result = std::fwrite(bytes.data(), bytes.size(), 1, file) == 1;
+    result = (std::fclose(file) == 0) && result;
+
+    if (!result || std::rename(temporaryPath.c_str(), std::string(path).c_str()) != 0)
+    {
+        logWarning("Failed to write KTX2 file: {}", path);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
\ No newline at end of file
@@ -0,0 +1,284 @@
+#include "Logger.hpp"
+
+#include "Hash.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr std::array<std::string_view, 4> LEVEL_NAMES { "Debug", "Info", "Warning", "Error" };
+
+    std::string_view getLevelName(LogLevel level)
+    {
+        return LEVEL_NAMES[static_cast<size_t>(level)];
+    }
+
+    void writeLine(const std::string& line)
+    {
+        std::fwrite(line.data(), 1, line.size(), stdout);
+    }
+}
+
+
+std::atomic<bool> Logger::s_destroyed = false;
+
+Logger* Logger::get()
+{
+    static Logger logger;
+    return s_destroyed.load(std::memory_order_acquire) ? nullptr : &logger;
+}
+
+Logger::Logger() : m_epoch(std::chrono::steady_clock::now()), m_records(std::make_unique<LogRecord[]>(QUEUE_CAPACITY))
+{
+    for (size_t idx = 0; idx < QUEUE_CAPACITY; ++idx)
+    {
+        m_records[idx].sequence.store(idx, std::memory_order_relaxed);
+    }
+
+    m_thread = std::thread(&Logger::run, this);
+}
+
+Logger::~Logger()
+{
+    s_destroyed.store(true, std::memory_order_release);
+    m_stopping.store(true, std::memory_order_release);
+
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+
+    m_thread.join();
+}
+
+LogRecord* Logger::acquire(LogLevel level, std::string_view format, bool limited)
+{
+    uint32_t suppressed = 0;
+
+    if (limited && !limitRate(format, suppressed))
+    {
+        return nullptr;
+    }
+
+    size_t position = m_enqueuePosition.load(std::memory_order_relaxed);
+
+    for (;;)
+    {
+        LogRecord& record = m_records[position & (QUEUE_CAPACITY - 1)];
+        const size_t sequence = record.sequence.load(std::memory_order_acquire);
+        const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+
+        if (difference == 0)
+        {
+            if (m_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                record.level = level;
+                record.suppressed = suppressed;
+                return &record;
+            }
+        }
+        else if (difference < 0)
+        {
+            // The writer has not freed the record from the previous lap yet.
+            if (level != LogLevel::Error && !m_blocking.load(std::memory_order_relaxed))
+            {
+                m_dropped.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            std::this_thread::yield();
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            position = m_enqueuePosition.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void Logger::publish(LogRecord& record, size_t size)
+{
+    record.length = static_cast<uint32_t>(std::min(size, LogRecord::TEXT_SIZE));
+
+    if (size > LogRecord::TEXT_SIZE)
+    {
+        std::memcpy(record.text.data() + LogRecord::TEXT_SIZE - 3, "...", 3);
+    }
+
+    // Only the claiming thread touches the sequence between acquire and publish.
+    record.sequence.store(record.sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+
+    m_signal.fetch_add(1, std::memory_order_release);
+    m_signal.notify_one();
+}
+
+void Logger::setBlocking(bool blocking)
+{
+    m_blocking.store(blocking, std::memory_order_relaxed);
+}
+
+void Logger::writeDirect(LogLevel level, std::string_view text)
+{
+    writeLine(std::format("[{}] {}\n", getLevelName(level), text));
+    std::fflush(stdout);
+}
+
+Logger::Site* Logger::findSite(std::string_view format)
+{
+    const char* key = format.data();
+    const uint64_t hash = fnv1a(&key, sizeof(key));
+
+    for (size_t probe = 0; probe < SITE_PROBES; ++probe)
+    {
+        Site& site = m_sites[(hash + probe) % SITE_COUNT];
+        const char* current = site.format.load(std::memory_order_acquire);
+
+        if (current == nullptr && site.format.compare_exchange_strong(current, key, std::memory_order_acq_rel))
+        {
+            site.formatSize.store(format.size(), std::memory_order_relaxed);
+            return &site;
+        }
+
+        if (current == key)
+        {
+            return &site;
+        }
+    }
+
+    return nullptr;
+}
+
+bool Logger::limitRate(std::string_view format, uint32_t& suppressed)
+{
+    Site* site = findSite(format);
+
+    // Sites that do not fit the table are not limited.
+    if (site == nullptr)
+    {
+        return true;
+    }
+
+    const int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+    int64_t windowStart = site->windowStart.load(std::memory_order_relaxed);
+
+    if (now - windowStart >= RATE_LIMIT_WINDOW.count() && site->windowStart.compare_exchange_strong(windowStart, now, std::memory_order_relaxed))
+    {
+        site->count.store(0, std::memory_order_relaxed);
+        suppressed = site->suppressed.exchange(0, std::memory_order_relaxed);
+    }
+
+    if (site->count.fetch_add(1, std::memory_order_relaxed) < RATE_LIMIT_BURST)
+    {
+        return true;
+    }
+
+    site->suppressed.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+void Logger::run()
+{
+    for (;;)
+    {
+        // Read before draining, so a publish racing with the drain changes
+        // the value and the wait returns immediately.
+        const uint32_t signal = m_signal.load(std::memory_order_acquire);
+
+        if (drain())
+        {
+            continue;
+        }
+
+        std::fflush(stdout);
+
+        if (m_stopping.load(std::memory_order_acquire))
+        {
+            break;
+        }
+
+        m_signal.wait(signal, std::memory_order_acquire);
+    }
+
+    writeRepeats();
+    writeSuppressed();
+    std::fflush(stdout);
+}
+
+bool Logger::drain()
+{
+    bool drained = false;
+
+    for (;;)
+    {
+        LogRecord& record = m_records[m_dequeuePosition & (QUEUE_CAPACITY - 1)];
+
+        if (record.sequence.load(std::memory_order_acquire) != m_dequeuePosition + 1)
+        {
+            break;
+        }
+
+        write(record.level, std::string_view(record.text.data(), record.length), record.suppressed);
+
+        record.sequence.store(m_dequeuePosition + QUEUE_CAPACITY, std::memory_order_release);
+        ++m_dequeuePosition;
+        drained = true;
+    }
+
+    const size_t dropped = m_dropped.load(std::memory_order_relaxed);
+
+    if (dropped != m_reportedDrops)
+    {
+        writeRepeats();
+        writeLine(std::format("[Warning] Log queue full, dropped {} messages\n", dropped - m_reportedDrops));
+        m_reportedDrops = dropped;
+    }
+
+    return drained;
+}
+
+void Logger::write(LogLevel level, std::string_view text, uint32_t suppressed)
+{
+    if (suppressed == 0 && level == m_lastLevel && text == m_lastText)
+    {
+        ++m_repeats;
+        return;
+    }
+
+    writeRepeats();
+
+    m_lastLevel = level;
+    m_lastText.assign(text);
+
+    if (suppressed > 0)
+    {
+        writeLine(std::format("[{}] {} ({} similar messages suppressed)\n", getLevelName(level), text, suppressed));
+    }
+    else
+    {
+        writeLine(std::format("[{}] {}\n", getLevelName(level), text));
+    }
+}
+
+void Logger::writeRepeats()
+{
+    if (m_repeats > 0)
+    {
+        writeLine(std::format("[{}] Previous message repeated {} times\n", getLevelName(m_lastLevel), m_repeats));
+        m_repeats = 0;
+    }
+}
+
+void Logger::writeSuppressed()
+{
+    for (const Site& site : m_sites)
+    {
+        const uint32_t suppressed = site.suppressed.load(std::memory_order_relaxed);
+
+        if (suppressed > 0)
+        {
+            const std::string_view format(site.format.load(std::memory_order_relaxed), site.formatSize.load(std::memory_order_relaxed));
+            writeLine(std::format("[Warning] Suppressed {} messages like: {}\n", suppressed, format));
+        }
+    }
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include <cmath>
+#include <chrono>
 #include <optional>
 #include <string_view>
 
@@ -13,8 +14,24 @@
 #include "Model.hpp"
 #include "Logger.hpp"
 #include "Shader.hpp"
+#include "Scene.hpp"
 #include "Camera.hpp"
-
+#include "Profiler.hpp"
+#include "ProgramCache.hpp"
+#include "Benchmark.hpp"
+#include "RenderQueue.hpp"
+#include "RenderStats.hpp"
+#include "GLInstrumentation.hpp"
+#include "UniformRing.hpp"
+#include "TextureCache.hpp"
+#include "TextureLoader.hpp"
+#include "TextureStreamer.hpp"
+
+
+constexpr std::chrono::microseconds TEXTURE_UPLOAD_BUDGET(2000);
+constexpr size_t TEXTURE_STREAMING_BUDGET = 128ull << 20;
+constexpr size_t UNIFORM_RING_FRAME_SIZE = 256ull << 10;
+constexpr VertexFormat MODEL_VERTEX_FORMAT = VertexFormat::Packed;
 
 uint32_t g_width = 800;
 uint32_t g_height = 600;
@@ -180,19 +197,52 @@ void processInput(GLFWwindow* window)
     }
 }
 
-int main()
+int main(int argc, char** argv)
 {
+    const std::optional<CommandLine> commandLine = parseCommandLine(argc, argv);
+
+    if (!commandLine)
+    {
+        return -1;
+    }
+
+    const SceneDescription& sceneDescription = *findScene(commandLine->scene);
+
+    if (!commandLine->trace.empty())
+    {
+        Profiler::get().setEnabled(true);
+        Profiler::get().setThreadName("Main");
+    }
+
     if (glfwInit() != GLFW_TRUE)
     {
         return -1;
     }
 
-    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    if (commandLine->benchmark)
+    {
+        // Nothing is presented, so a hidden window only provides the context;
+        // in CI it runs on Mesa llvmpipe under a virtual X server.
+        glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+        g_width = commandLine->width;
+        g_height = commandLine->height;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
     glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
     glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
 
     GLFWwindow* window = glfwCreateWindow(g_width, g_height, "LearnOpenGL", nullptr, nullptr);
-    
+
+    if (window == nullptr)
+    {
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+
+        window = glfwCreateWindow(g_width, g_height, "LearnOpenGL", nullptr, nullptr);
+    }
+
     if (window == nullptr)
     {
         glfwTerminate();
@@ -209,10 +259,24 @@ int main()
     int result = glewInit();
     if (result != GLEW_OK)
     {
-        log("[Error] GLEW initialization failed: {}", (char*)glewGetErrorString(result));
+        logError("GLEW initialization failed: {}", (char*)glewGetErrorString(result));
         return -1;
     }
 
+    std::optional<OffscreenTarget> offscreenTarget;
+
+    if (commandLine->benchmark)
+    {
+        offscreenTarget = OffscreenTarget::create(g_width, g_height);
+
+        if (!offscreenTarget)
+        {
+            return -1;
+        }
+
+        offscreenTarget->bind();
+    }
+
     std::vector<Vertex> vertices
     {
         { glm::vec3(-0.5f, -0.5f, -0.5f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec2(0.0f, 0.0f) },
@@ -262,7 +326,7 @@ int main()
 
     // if (!diffuseMap || !specularMap)
     // {
-    //     log("[Error] Texture loading failed");
+    //     logError("Texture loading failed");
     //     return -1;
     // }
 
@@ -335,7 +399,7 @@ int main()
 
     // if (!shaderOpt)
     // {
-    //     log("[Error] Shader program creation failed");
+    //     logError("Shader program creation failed");
     //     return -1;
     // }
 
@@ -364,16 +428,18 @@ int main()
     auto shaderOpt = Shader::create("shaders/Cube.vs", "shaders/Light.fs");
     if (!shaderOpt)
     {
-        log("[Error] Shader program creation failed");
+        logError("Shader program creation failed");
         return -1;
     }
 
     Shader lightShader = std::move(*shaderOpt);
 
-    shaderOpt = Shader::create("shaders/ModelWithLight.vs", "shaders/ModelWithLight.fs");
+    const char* modelVertexShader = MODEL_VERTEX_FORMAT == VertexFormat::Packed ? "shaders/ModelWithLightPacked.vs" : "shaders/ModelWithLight.vs";
+
+    shaderOpt = Shader::create(modelVertexShader, "shaders/ModelWithLight.fs");
     if (!shaderOpt)
     {
-        log("[Error] Shader program creation failed");
+        logError("Shader program creation failed");
         return -1;
     }
 
@@ -382,40 +448,99 @@ int main()
     const glm::vec3 lightPos(1.2f, 1.0f, 15.0f);
 
     modelShader.use();
-
-    modelShader.setVec3("light.position", lightPos);
-    
     modelShader.setFloat("shininess", 32.0f);
 
-    modelShader.setVec3("light.ambient", glm::vec3(0.2f, 0.2f, 0.2f));
-    modelShader.setVec3("light.diffuse", glm::vec3(0.7f, 0.7f, 0.7f));
-    modelShader.setVec3("light.specular", glm::vec3(1.0f, 1.0f, 1.0f));
-    
-    modelShader.setFloat("light.constant", 1.0f);
-    // modelShader.setFloat("light.linear", 0.09f);
-    // modelShader.setFloat("light.quadratic", 0.032f);
-    modelShader.setFloat("light.linear", 0.00f);
-    modelShader.setFloat("light.quadratic", 0.0f);
+    LightBlock light;
+    light.position = glm::vec4(lightPos, 1.0f);
+    light.ambient = glm::vec4(0.2f, 0.2f, 0.2f, 0.0f);
+    light.diffuse = glm::vec4(0.7f, 0.7f, 0.7f, 0.0f);
+    light.specular = glm::vec4(1.0f, 1.0f, 1.0f, 0.0f);
+    light.constant = 1.0f;
+    // light.linear = 0.09f;
+    // light.quadratic = 0.032f;
+    light.linear = 0.0f;
+    light.quadratic = 0.0f;
+    light.padding = 0.0f;
+
+    UniformRing uniformRing = UniformRing::create(UNIFORM_RING_FRAME_SIZE);
+
+    if (!uniformRing.isPersistent())
+    {
+        logInfo("Persistent buffer mapping unavailable, uniform ring uses glBufferSubData");
+    }
+
 
+    TextureStreamer::get().setBudget(TEXTURE_STREAMING_BUDGET);
 
-    // auto modelOpt = Model::create("assets/backpack/backpack.obj");
-    auto modelOpt = Model::create("assets/globe/globe.obj");
+    auto modelOpt = Model::create(sceneDescription.modelPath, ModelLoadOptions { MODEL_VERTEX_FORMAT, true });
     if (!modelOpt)
     {
-        log("[Error] Model loading failed");
+        logError("Model loading failed");
         return -1;
     }
 
-    Model backpackModel = std::move(*modelOpt);
+    Model sceneModel = std::move(*modelOpt);
+    sceneModel.setDrawMode(Model::DrawMode::Indirect);
+
+    const TextureCache::Stats textureStats = TextureCache::get().getStats();
+    logInfo("Texture cache: {} textures, {} hits, {} misses", textureStats.residentCount, textureStats.hits, textureStats.misses);
+
+    const ProgramCache::Stats programStats = ProgramCache::get().getStats();
+    logInfo("Program cache: {} hits ({:.1f} ms), {} misses, {} rejected, {} compiled ({:.1f} ms), {} stored",
+        programStats.hits, programStats.loadTime, programStats.misses, programStats.rejected, programStats.compiled, programStats.compileTime, programStats.stored);
+
+    glm::mat4 sceneTransform = glm::mat4(1.0f);
+
+    sceneTransform = glm::translate(sceneTransform, glm::vec3(0.0f, 0.0f, 0.0f));
+    sceneTransform = glm::scale(sceneTransform, glm::vec3(sceneDescription.scale));
+
+    Scene scene;
+    scene.addInstance(sceneModel, modelShader, sceneTransform);
+
+    RenderQueue renderQueue;
+
+    BenchmarkRecorder benchmarkRecorder;
+    uint32_t frame = 0;
+    bool wasPickPressed = false;
 
     glEnable(GL_DEPTH_TEST);
     while (!glfwWindowShouldClose(window))
     {
+        const auto frameStart = std::chrono::steady_clock::now();
         const float currentFrame = glfwGetTime();
         deltaTime = currentFrame - lastFrame;
         lastFrame = currentFrame;
 
-        processInput(window);
+        Profiler::get().beginFrame();
+        ProfileZone frameZone("Frame");
+        GpuProfileZone gpuFrameZone("Frame");
+
+        RenderStats::reset();
+
+        const bool isMeasuring = commandLine->benchmark && frame >= commandLine->warmupFrames;
+
+        if (commandLine->benchmark)
+        {
+            // Measured frames must not depend on how far the loader threads
+            // got: the model's textures land before the first frame, warmup
+            // frames drain their streaming requests right away and measured
+            // frames do not stream at all.
+            if (frame == 0)
+            {
+                TextureLoader::get().finish();
+            }
+
+            camera = getBenchmarkCamera(frame, commandLine->frames, sceneDescription.orbitRadius);
+        }
+        else
+        {
+            processInput(window);
+        }
+
+        {
+            ProfileZone zone("TextureLoader::upload");
+            TextureLoader::get().upload(TEXTURE_UPLOAD_BUDGET);
+        }
 
         glClearColor(0.2f, 0.3f, 0.3f, 1.0f);
         glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
@@ -424,19 +549,42 @@ int main()
 
         glm::mat4 projection = glm::perspective(glm::radians(camera.getZoom()), (float)g_width / (float)g_height, 0.1f, 100.0f);
         glm::mat4 view = camera.getViewMatrix();
-        glm::mat4 model = glm::mat4(1.0f);
 
-        model = glm::translate(model, glm::vec3(0.0f, 0.0f, 0.0f));
-        // model = glm::scale(model, glm::vec3(1.0f, 1.0f, 1.0f));
-        model = glm::scale(model, glm::vec3(0.1f, 0.1f, 0.1f));
+        uniformRing.beginFrame();
+
+        const CameraBlock cameraBlock { projection, view, glm::vec4(camera.getPosition(), 1.0f) };
+
+        uniformRing.bind(UniformBinding::Camera, uniformRing.push(cameraBlock));
+        uniformRing.bind(UniformBinding::Light, uniformRing.push(light));
 
-        modelShader.use();
-        modelShader.setVec3("viewPos", camera.getPosition());
-        modelShader.setMat4("projection", projection);
-        modelShader.setMat4("view", view);
-        modelShader.setMat4("model", model);
+        {
+            ProfileZone zone("Scene::submit");
+            scene.submit(renderQueue, projection * view, camera.getPosition(), camera.getProjectionScale(static_cast<float>(g_height)));
+        }
+
+        if (!isMeasuring)
+        {
+            ProfileZone zone("TextureStreamer::update");
+            TextureStreamer::get().update();
+
+            if (commandLine->benchmark)
+            {
+                TextureLoader::get().finish();
+            }
+        }
 
-        backpackModel.draw(modelShader);
+        // Pick once per key press rather than on every frame it is held.
+        const bool isPickPressed = glfwGetKey(window, GLFW_KEY_P) == GLFW_PRESS;
+
+        if (isPickPressed && !wasPickPressed)
+        {
+            if (auto hit = scene.pick(Ray { camera.getPosition(), camera.getFront() }))
+            {
+                logInfo("Picked mesh {} triangle {} at distance {}", hit->mesh, hit->triangle, hit->distance);
+            }
+        }
+
+        wasPickPressed = isPickPressed;
 
         // cubeShader.use();
         // cubeShader.setVec3("viewPos", camera.getPosition());
@@ -455,23 +603,64 @@ int main()
         //     cubeMesh.draw(cubeShader);
         // }
 
-        lightShader.use();
-
-        lightShader.setMat4("projection", projection);
-        lightShader.setMat4("view", view);
-
-        model = glm::mat4(1.0f);
+        glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, lightPos);
         model = glm::scale(model, glm::vec3(0.2f));
 
-        lightShader.setMat4("model", model);
+        renderQueue.submit(lightShader, lightMesh, model, glm::length(camera.getPosition() - lightPos));
+
+        renderQueue.flush(uniformRing);
+
+        uniformRing.endFrame();
+        GLInstrumentation::endFrame();
+
+        if (commandLine->benchmark)
+        {
+            const auto cpuEnd = std::chrono::steady_clock::now();
+            glFinish();
+            const auto frameEnd = std::chrono::steady_clock::now();
 
-        lightMesh.draw(lightShader);
+            if (frame >= commandLine->warmupFrames)
+            {
+                const double cpuTime = std::chrono::duration<double, std::milli>(cpuEnd - frameStart).count();
+                const double frameTime = std::chrono::duration<double, std::milli>(frameEnd - frameStart).count();
+
+                benchmarkRecorder.addFrame(cpuTime, frameTime, RenderStats::get(), GLInstrumentation::getLastFrameCalls());
+            }
+
+            if (++frame == commandLine->warmupFrames + commandLine->frames)
+            {
+                break;
+            }
+
+            glfwPollEvents();
+            continue;
+        }
 
         glfwSwapBuffers(window);
         glfwPollEvents();
     }
 
+    if (commandLine->benchmark)
+    {
+        const char* renderer = reinterpret_cast<const char*>(glGetString(GL_RENDERER));
+        const char* version = reinterpret_cast<const char*>(glGetString(GL_VERSION));
+
+        if (!benchmarkRecorder.write(*commandLine, renderer != nullptr ? renderer : "", version != nullptr ? version : ""))
+        {
+            return -1;
+        }
+
+        logInfo("Benchmark of {} frames written to {}", commandLine->frames, commandLine->output);
+    }
+
+    if (!commandLine->trace.empty())
+    {
+        Profiler::get().writeTrace(commandLine->trace);
+    }
+
+    GLInstrumentation::report();
+
     glfwDestroyWindow(window);
     glfwTerminate();
 
@@ -1,22 +1,127 @@
 #include "Mesh.hpp"
+#include "Hash.hpp"
 #include "Logger.hpp"
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "RenderStats.hpp"
+#include "TextureStreamer.hpp"
 
 #include <GL/glew.h>
 
 #define STB_IMAGE_IMPLEMENTATION
 #include <stb/stb_image.h>
 
+#include <cmath>
+#include <algorithm>
+#include <filesystem>
+
+
+namespace
+{
+    // Coarsest LOD whose simplification error may cover on screen.
+    constexpr float LOD_PIXEL_ERROR = 1.0f;
+
+    std::vector<std::string> createSamplerNames(const std::vector<Texture>& textures)
+    {
+        uint32_t diffuseNr = 1;
+        uint32_t specularNr = 1;
+        uint32_t normalNr = 1;
+        uint32_t heightNr = 1;
+
+        std::vector<std::string> names;
+        names.reserve(textures.size());
+
+        for (const Texture& texture : textures)
+        {
+            if (texture.type == Texture::Type::Diffuse)
+            {
+                names.push_back(std::string("texture_diffuse") + std::to_string(diffuseNr++));
+            }
+            else if (texture.type == Texture::Type::Specular)
+            {
+                names.push_back(std::string("texture_specular") + std::to_string(specularNr++));
+            }
+            else if (texture.type == Texture::Type::Normal)
+            {
+                names.push_back(std::string("texture_normal") + std::to_string(normalNr++));
+            }
+            else if (texture.type == Texture::Type::Height)
+            {
+                names.push_back(std::string("texture_height") + std::to_string(heightNr++));
+            }
+        }
+
+        return names;
+    }
+
+    uint64_t createTextureKey(const std::vector<Texture>& textures)
+    {
+        uint64_t key = FNV_OFFSET_BASIS;
+
+        // Keyed by resource rather than GL name: names change as textures
+        // stream and may be reused by another texture.
+        for (const Texture& texture : textures)
+        {
+            const TextureResource* resource = texture.resource.get();
+            key = fnv1a(&resource, sizeof(resource), key);
+        }
+
+        return textures.empty() ? 0 : key;
+    }
+
+    // Immutable storage lets the driver allocate the whole chain up front and
+    // skip completeness checks; it replaces the placeholder image.
+    bool hasTextureStorage()
+    {
+        return GLEW_VERSION_4_2 || GLEW_ARB_texture_storage;
+    }
+
+    // Swaps in a fresh GL object and leaves it bound to unit 0.
+    void replaceObject(TextureResource& texture)
+    {
+        uint32_t id;
+        glGenTextures(1, &id);
+
+        GLState::forgetTexture(texture.id);
+        glDeleteTextures(1, &texture.id);
+
+        texture.id = id;
+        GLState::bindTexture(0, id);
+    }
+
+    void setSamplerParameters(int32_t levelCount)
+    {
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+    }
+}
+
+
+TextureResource::TextureResource(uint32_t id, size_t bytes) : id(id), bytes(bytes) {}
+
+TextureResource::~TextureResource()
+{
+    GLState::forgetTexture(id);
+    glDeleteTextures(1, &id);
+}
 
 std::optional<Texture> Texture::load(const std::string& file, const std::string& directory, Type type)
 {
-    uint32_t texture;
-    glGenTextures(1, &texture);
-    glBindTexture(GL_TEXTURE_2D, texture);
+    if (std::optional<Ktx2Image> image = readKtx2(getCompressedPath(directory + '/' + file)))
+    {
+        const uint32_t format = getCompressedFormat(image->format);
 
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        if (format != 0 && image->flippedVertically)
+        {
+            auto texture = std::make_shared<TextureResource>(0);
+            uploadCompressed(*texture, *image, format);
+
+            return std::make_optional(Texture { std::move(texture), type, file });
+        }
+    }
 
     stbi_set_flip_vertically_on_load(true);
 
@@ -25,86 +130,256 @@ std::optional<Texture> Texture::load(const std::string& file, const std::string&
 
     if (data == nullptr)
     {
-        log("[Error] Failed to load texture: {}", file);
+        logError("Failed to load texture: {}", file);
         return std::nullopt;
     }
 
-    GLenum format = GL_RGB;
+    const MipChain mips = buildMipChain(data, width, height, channels, type == Type::Diffuse);
+
+    stbi_image_free(data);
+
+    auto texture = std::make_shared<TextureResource>(0);
+    upload(*texture, mips);
+
+    return std::make_optional(Texture { std::move(texture), type, file });
+}
+
+uint32_t Texture::getId() const
+{
+    return resource ? resource->id : 0;
+}
+
+size_t Texture::getMemorySize(const MipChain& mips, uint32_t firstLevel)
+{
+    return firstLevel < mips.levels.size() ? mips.data.size() - mips.levels[firstLevel].offset : 0;
+}
+
+size_t Texture::getMemorySize(const Ktx2Image& image)
+{
+    size_t size = 0;
+
+    for (const Ktx2Image::Level& level : image.levels)
+    {
+        size += level.size;
+    }
+
+    return size;
+}
+
+std::string Texture::getCompressedPath(std::string_view path)
+{
+    return std::filesystem::path(path).replace_extension(".ktx2").string();
+}
+
+uint32_t Texture::getCompressedFormat(CompressedFormat format)
+{
+    const bool s3tc = GLEW_EXT_texture_compression_s3tc;
+    const bool s3tcSrgb = s3tc && GLEW_EXT_texture_sRGB;
+    const bool bptc = GLEW_VERSION_4_2 || GLEW_ARB_texture_compression_bptc;
+    const bool etc2 = GLEW_VERSION_4_3 || GLEW_ARB_ES3_compatibility;
+
+    switch (format)
+    {
+    case CompressedFormat::Bc1:
+        return s3tc ? GL_COMPRESSED_RGB_S3TC_DXT1_EXT : 0;
+    case CompressedFormat::Bc1Srgb:
+        return s3tcSrgb ? GL_COMPRESSED_SRGB_S3TC_DXT1_EXT : 0;
+    case CompressedFormat::Bc1Alpha:
+        return s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT1_EXT : 0;
+    case CompressedFormat::Bc1AlphaSrgb:
+        return s3tcSrgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT : 0;
+    case CompressedFormat::Bc3:
+        return s3tc ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : 0;
+    case CompressedFormat::Bc3Srgb:
+        return s3tcSrgb ? GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT : 0;
+    case CompressedFormat::Bc5:
+        return GL_COMPRESSED_RG_RGTC2;
+    case CompressedFormat::Bc7:
+        return bptc ? GL_COMPRESSED_RGBA_BPTC_UNORM : 0;
+    case CompressedFormat::Bc7Srgb:
+        return bptc ? GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM : 0;
+    case CompressedFormat::Etc2:
+        return etc2 ? GL_COMPRESSED_RGB8_ETC2 : 0;
+    case CompressedFormat::Etc2Srgb:
+        return etc2 ? GL_COMPRESSED_SRGB8_ETC2 : 0;
+    case CompressedFormat::Etc2Alpha:
+        return etc2 ? GL_COMPRESSED_RGBA8_ETC2_EAC : 0;
+    case CompressedFormat::Etc2AlphaSrgb:
+        return etc2 ? GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC : 0;
+    }
+
+    return 0;
+}
+
+uint32_t Texture::createPlaceholder()
+{
+    static constexpr uint8_t placeholder[4] = { 128, 128, 128, 255 };
+
+    uint32_t texture;
+    glGenTextures(1, &texture);
+    GLState::bindTexture(0, texture);
+
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, placeholder);
+
+    return texture;
+}
+
+void Texture::upload(TextureResource& texture, const MipChain& mips, uint32_t firstLevel)
+{
+    const int32_t levelCount = static_cast<int32_t>(mips.levels.size() - firstLevel);
+    const MipChain::Level& base = mips.levels[firstLevel];
+
+    replaceObject(texture);
+    setSamplerParameters(levelCount);
 
-    if (channels == 1)
+    if (hasTextureStorage())
     {
-        format = GL_RED;
+        glTexStorage2D(GL_TEXTURE_2D, levelCount, GL_RGBA8, base.width, base.height);
     }
-    else if (channels == 3)
+
+    // The levels come from buildMipChain(); the driver generates nothing.
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int32_t level = 0; level < levelCount; ++level)
     {
-        format = GL_RGB;
+        const MipChain::Level& data = mips.levels[firstLevel + level];
+        const uint8_t* pixels = mips.data.data() + data.offset;
+
+        if (hasTextureStorage())
+        {
+            glTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, data.width, data.height, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, GL_RGBA8, data.width, data.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+        }
     }
-    else if (channels == 4)
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    texture.bytes = getMemorySize(mips, firstLevel);
+    texture.residentLevel = firstLevel;
+}
+
+void Texture::uploadCompressed(TextureResource& texture, const Ktx2Image& image, uint32_t internalFormat)
+{
+    const int32_t levelCount = static_cast<int32_t>(image.levels.size());
+
+    replaceObject(texture);
+    setSamplerParameters(levelCount);
+
+    if (hasTextureStorage())
     {
-        format = GL_RGBA;
+        glTexStorage2D(GL_TEXTURE_2D, levelCount, internalFormat, image.width, image.height);
     }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, format, width, height, 0, format, GL_UNSIGNED_BYTE, data);
-    glGenerateMipmap(GL_TEXTURE_2D);
+    // The mip chain comes precomputed from the file; nothing is generated here.
+    for (int32_t level = 0; level < levelCount; ++level)
+    {
+        const Ktx2Image::Level& data = image.levels[level];
+        const int32_t size = static_cast<int32_t>(data.size);
+        const uint8_t* blocks = image.data.data() + data.offset;
 
-    stbi_image_free(data);
+        if (hasTextureStorage())
+        {
+            glCompressedTexSubImage2D(GL_TEXTURE_2D, level, 0, 0, data.width, data.height, internalFormat, size, blocks);
+        }
+        else
+        {
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, internalFormat, data.width, data.height, 0, size, blocks);
+        }
+    }
 
-    return std::make_optional(Texture { texture, type, file });
+    texture.bytes = getMemorySize(image);
+    texture.residentLevel = 0;
 }
 
 
-Mesh Mesh::create(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices, const std::vector<Texture>& textures)
+Mesh Mesh::create(std::span<const Vertex> vertices, std::span<const uint32_t> indices, const std::vector<Texture>& textures, std::span<const MeshLod> lods, bool keepGeometry)
 {
-    uint32_t vertexArray;
-    glGenVertexArrays(1, &vertexArray);
-    glBindVertexArray(vertexArray);
+    return create(GeometryArena::create(vertices.size(), indices.size()), vertices, indices, textures, lods, keepGeometry);
+}
 
-    uint32_t vertexBuffer;
-    glGenBuffers(1, &vertexBuffer);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(Vertex), vertices.data(), GL_STATIC_DRAW);
+Mesh Mesh::create(const std::shared_ptr<GeometryArena>& arena, std::span<const Vertex> vertices, std::span<const uint32_t> indices, const std::vector<Texture>& textures, std::span<const MeshLod> lods, bool keepGeometry)
+{
+    Mesh self;
 
-    uint32_t elementBuffer;
-    glGenBuffers(1, &elementBuffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, elementBuffer);
-    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(uint32_t), indices.data(), GL_STATIC_DRAW);
+    self.initialize(vertices, indices, textures, lods);
+    self.m_arena = arena;
+    self.m_range = arena->allocate(vertices, indices);
 
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, position)));
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, normal)));
-    glEnableVertexAttribArray(2);
-    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, sizeof(Vertex), reinterpret_cast<void*>(offsetof(Vertex, texCoords)));
+    if (keepGeometry)
+    {
+        self.m_vertices.assign(vertices.begin(), vertices.end());
+        self.m_indices.assign(indices.begin(), indices.end());
+    }
 
-    glBindVertexArray(0);
+    return self;
+}
 
+Mesh Mesh::create(const std::shared_ptr<GeometryArena>& arena, MeshData&& data, bool keepGeometry)
+{
     Mesh self;
 
-    self.m_vertices = vertices;
-    self.m_indices = indices;
-    self.m_textures = textures;
-    self.m_vertexArray = vertexArray;
-    self.m_vertexBuffer = vertexBuffer;
-    self.m_elementBuffer = elementBuffer;
+    self.initialize(data.vertices, data.indices, std::move(data.textures), data.lods);
+    self.m_arena = arena;
+    self.m_range = arena->allocate(data.vertices, data.indices);
+
+    if (keepGeometry)
+    {
+        self.m_vertices = std::move(data.vertices);
+        self.m_indices = std::move(data.indices);
+    }
 
     return self;
 }
 
-Mesh::~Mesh()
+Mesh Mesh::create(const std::shared_ptr<GeometryArena>& arena, std::span<const PackedVertex> vertices, std::span<const uint32_t> indices, const std::vector<Texture>& textures, std::span<const MeshLod> lods, bool keepGeometry)
 {
-    glDeleteVertexArrays(1, &m_vertexArray);
-    glDeleteBuffers(1, &m_vertexBuffer);
-    glDeleteBuffers(1, &m_elementBuffer);
+    std::vector<Vertex> unpacked;
+    unpacked.reserve(vertices.size());
+
+    for (const PackedVertex& vertex : vertices)
+    {
+        unpacked.push_back(unpackVertex(vertex, arena->getQuantization()));
+    }
+
+    Mesh self;
+
+    self.initialize(unpacked, indices, textures, lods);
+    self.m_arena = arena;
+    self.m_range = arena->allocate(vertices, indices);
+
+    if (keepGeometry)
+    {
+        self.m_vertices = std::move(unpacked);
+        self.m_indices.assign(indices.begin(), indices.end());
+    }
+
+    return self;
 }
 
+Mesh::~Mesh() = default;
+
 Mesh::Mesh(Mesh&& other) noexcept
 {
     std::swap(m_vertices, other.m_vertices);
     std::swap(m_indices, other.m_indices);
     std::swap(m_textures, other.m_textures);
-    std::swap(m_vertexArray, other.m_vertexArray);
-    std::swap(m_vertexBuffer, other.m_vertexBuffer);
-    std::swap(m_elementBuffer, other.m_elementBuffer);
+    std::swap(m_samplerNames, other.m_samplerNames);
+    std::swap(m_textureKey, other.m_textureKey);
+    std::swap(m_samplerProgram, other.m_samplerProgram);
+    std::swap(m_samplerHandles, other.m_samplerHandles);
+    std::swap(m_arena, other.m_arena);
+    std::swap(m_range, other.m_range);
+    std::swap(m_lods, other.m_lods);
+    std::swap(m_bounds, other.m_bounds);
+    std::swap(m_boundingSphere, other.m_boundingSphere);
 }
 
 Mesh& Mesh::operator=(Mesh&& other) noexcept
@@ -112,59 +387,213 @@ Mesh& Mesh::operator=(Mesh&& other) noexcept
     std::swap(m_vertices, other.m_vertices);
     std::swap(m_indices, other.m_indices);
     std::swap(m_textures, other.m_textures);
-    std::swap(m_vertexArray, other.m_vertexArray);
-    std::swap(m_vertexBuffer, other.m_vertexBuffer);
-    std::swap(m_elementBuffer, other.m_elementBuffer);
+    std::swap(m_samplerNames, other.m_samplerNames);
+    std::swap(m_textureKey, other.m_textureKey);
+    std::swap(m_samplerProgram, other.m_samplerProgram);
+    std::swap(m_samplerHandles, other.m_samplerHandles);
+    std::swap(m_arena, other.m_arena);
+    std::swap(m_range, other.m_range);
+    std::swap(m_lods, other.m_lods);
+    std::swap(m_bounds, other.m_bounds);
+    std::swap(m_boundingSphere, other.m_boundingSphere);
 
     return *this;
 }
 
-void Mesh::draw(Shader& shader) const
+void Mesh::draw(const Shader& shader, uint32_t lod) const
 {
-    uint32_t diffuseNr = 1;
-    uint32_t specularNr = 1;
-    uint32_t normalNr = 1;
-    uint32_t heightNr = 1;
+    ProfileZone zone("Mesh::draw");
 
-    for (size_t idx = 0; idx < m_textures.size(); ++idx)
+    bindMaterial(shader);
+    drawElements(lod);
+}
+
+void Mesh::bindMaterial(const Shader& shader) const
+{
+    const bool packed = m_arena->getFormat() == VertexFormat::Packed;
+
+    if (m_samplerProgram != shader.getId())
     {
-        glActiveTexture(GL_TEXTURE0 + idx);
+        m_samplerHandles.clear();
+
+        for (const std::string& name : m_samplerNames)
+        {
+            m_samplerHandles.push_back(shader.getUniform(name));
+        }
+
+        m_samplerProgram = shader.getId();
+    }
 
-        std::string name;
-        const Texture::Type type = m_textures[idx].type;
+    if (packed)
+    {
+        shader.setVec3(shader.getPositionOffsetUniform(), m_arena->getQuantization().offset);
+        shader.setVec3(shader.getPositionScaleUniform(), m_arena->getQuantization().scale);
+    }
 
-        if (type == Texture::Type::Diffuse)
+    for (size_t idx = 0; idx < m_textures.size(); ++idx)
+    {
+        if (!m_samplerHandles[idx].isValid())
         {
-            name = std::string("texture_diffuse") + std::to_string(diffuseNr++);
+            continue;
         }
-        else if (type == Texture::Type::Specular)
+
+        shader.setInt(m_samplerHandles[idx], idx);
+        GLState::bindTexture(idx, m_textures[idx].getId());
+    }
+}
+
+void Mesh::initialize(std::span<const Vertex> vertices, std::span<const uint32_t> indices, std::vector<Texture> textures, std::span<const MeshLod> lods)
+{
+    m_textures = std::move(textures);
+    m_samplerNames = createSamplerNames(m_textures);
+    m_textureKey = createTextureKey(m_textures);
+    m_lods.assign(lods.begin(), lods.end());
+
+    if (m_lods.empty())
+    {
+        m_lods.push_back({ 0, static_cast<uint32_t>(indices.size()), 0.0f });
+    }
+
+    m_bounds = AABB::fromVertices(vertices);
+    m_boundingSphere = BoundingSphere::fromVertices(vertices, m_bounds);
+}
+
+void Mesh::drawElements(uint32_t lod) const
+{
+    const GeometryArena::Range range = getLodRange(lod);
+
+    GLState::bindVertexArray(m_arena->getVertexArray());
+    glDrawElementsBaseVertex(GL_TRIANGLES, range.indexCount, GL_UNSIGNED_INT, reinterpret_cast<void*>(range.firstIndex * sizeof(uint32_t)), range.baseVertex);
+    RenderStats::countDraw(1, range.indexCount / 3);
+}
+
+uint32_t Mesh::getLodCount() const
+{
+    return static_cast<uint32_t>(m_lods.size());
+}
+
+uint32_t Mesh::selectLod(float distance, float projectionScale) const
+{
+    // Project each LOD's object-space error to pixels and keep the coarsest
+    // one that stays under the threshold. The errors grow with the LOD index.
+    const float pixelsPerUnit = projectionScale / std::max(distance, 1e-3f);
+
+    uint32_t lod = 0;
+
+    while (lod + 1 < m_lods.size() && m_lods[lod + 1].error * pixelsPerUnit <= LOD_PIXEL_ERROR)
+    {
+        ++lod;
+    }
+
+    return lod;
+}
+
+void Mesh::requestTextures(float distance, float projectionScale) const
+{
+    // The bounding sphere's diameter on screen: roughly how far a texture
+    // mapped once across the mesh gets stretched.
+    const float pixels = 2.0f * m_boundingSphere.radius * projectionScale / std::max(distance, 1e-3f);
+
+    for (const Texture& texture : m_textures)
+    {
+        if (texture.resource)
         {
-            name = std::string("texture_specular") + std::to_string(specularNr++);
+            TextureStreamer::get().request(texture.resource, pixels);
         }
-        else if (type == Texture::Type::Normal)
+    }
+}
+
+GeometryArena::Range Mesh::getLodRange(uint32_t lod) const
+{
+    const MeshLod& level = m_lods[std::min<size_t>(lod, m_lods.size() - 1)];
+
+    return GeometryArena::Range { m_range.baseVertex, m_range.firstIndex + level.firstIndex, level.indexCount };
+}
+
+uint32_t Mesh::getVertexArray() const
+{
+    return m_arena->getVertexArray();
+}
+
+uint64_t Mesh::getTextureKey() const
+{
+    return m_textureKey;
+}
+
+
+bool Mesh::hasGeometry() const
+{
+    return !m_indices.empty();
+}
+
+std::optional<MeshHit> Mesh::intersect(const Ray& ray, float maxDistance) const
+{
+    constexpr float EPSILON = 1e-7f;
+
+    std::optional<MeshHit> closest;
+
+    if (!hasGeometry())
+    {
+        return closest;
+    }
+
+    // Möller-Trumbore against every triangle of LOD 0, both faces.
+    for (size_t idx = 0; idx + 2 < m_lods.front().indexCount; idx += 3)
+    {
+        const glm::vec3& v0 = m_vertices[m_indices[idx]].position;
+        const glm::vec3& v1 = m_vertices[m_indices[idx + 1]].position;
+        const glm::vec3& v2 = m_vertices[m_indices[idx + 2]].position;
+
+        const glm::vec3 edge1 = v1 - v0;
+        const glm::vec3 edge2 = v2 - v0;
+        const glm::vec3 p = glm::cross(ray.direction, edge2);
+        const float determinant = glm::dot(edge1, p);
+
+        if (std::abs(determinant) < EPSILON)
         {
-            name = std::string("texture_normal") + std::to_string(normalNr++);
+            continue;
         }
-        else if (type == Texture::Type::Height)
+
+        const float inverseDeterminant = 1.0f / determinant;
+        const glm::vec3 t = ray.origin - v0;
+        const float u = glm::dot(t, p) * inverseDeterminant;
+
+        if (u < 0.0f || u > 1.0f)
         {
-            name = std::string("texture_height") + std::to_string(heightNr++);
+            continue;
         }
 
-        int32_t location = glGetUniformLocation(shader.getId(), name.c_str());
+        const glm::vec3 q = glm::cross(t, edge1);
+        const float v = glm::dot(ray.direction, q) * inverseDeterminant;
 
-        if (location == -1)
+        if (v < 0.0f || u + v > 1.0f)
         {
-            log("[Warning] Uniform not found: {}", name);
             continue;
         }
 
-        glUniform1i(location, idx);
-        glBindTexture(GL_TEXTURE_2D, m_textures[idx].id);
+        const float distance = glm::dot(edge2, q) * inverseDeterminant;
+
+        if (distance >= 0.0f && distance < maxDistance)
+        {
+            maxDistance = distance;
+            closest = MeshHit { static_cast<uint32_t>(idx / 3), distance };
+        }
     }
 
-    glBindVertexArray(m_vertexArray);
-    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, nullptr);
-    glBindVertexArray(0);
+    return closest;
+}
 
-    glActiveTexture(GL_TEXTURE0);
+const AABB& Mesh::getBounds() const
+{
+    return m_bounds;
+}
+
+const BoundingSphere& Mesh::getBoundingSphere() const
+{
+    return m_boundingSphere;
 }
+
+const GeometryArena& Mesh::getArena() const
+{
+    return *m_arena;
+}
\ No newline at end of file
@@ -0,0 +1,433 @@
+#include "MeshCache.hpp"
+
+#include "Hash.hpp"
+#include "Logger.hpp"
+
+#include <string>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+namespace
+{
+    constexpr char CACHE_MAGIC[8] = { 'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H' };
+    constexpr uint32_t CACHE_VERSION = 4;
+    constexpr size_t CACHE_ALIGNMENT = 16;
+
+    struct CacheHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t meshCount;
+        uint64_t sourceSize;
+        int64_t sourceMtime;
+        uint64_t sourceHash;
+        uint32_t vertexFormat;
+        uint32_t reserved;
+        float quantizationOffset[3];
+        float quantizationScale[3];
+    };
+
+    struct MeshRecord
+    {
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t textureCount;
+        uint32_t lodCount;
+    };
+
+    struct TextureRecord
+    {
+        uint32_t type;
+        uint32_t length;
+    };
+
+    struct SourceInfo
+    {
+        uint64_t size;
+        int64_t mtime;
+    };
+
+    std::string cachePath(std::string_view sourcePath)
+    {
+        return std::string(sourcePath) + ".meshcache";
+    }
+
+    std::optional<SourceInfo> statSource(std::string_view sourcePath)
+    {
+        struct stat info;
+
+        if (stat(std::string(sourcePath).c_str(), &info) != 0)
+        {
+            return std::nullopt;
+        }
+
+        const int64_t mtime = static_cast<int64_t>(info.st_mtim.tv_sec) * 1000000000 + info.st_mtim.tv_nsec;
+
+        return SourceInfo { static_cast<uint64_t>(info.st_size), mtime };
+    }
+
+    std::optional<uint64_t> hashSource(std::string_view sourcePath)
+    {
+        FILE* file = std::fopen(std::string(sourcePath).c_str(), "rb");
+
+        if (file == nullptr)
+        {
+            return std::nullopt;
+        }
+
+        uint64_t hash = FNV_OFFSET_BASIS;
+        char buffer[64 * 1024];
+        size_t size;
+
+        while ((size = std::fread(buffer, 1, sizeof(buffer), file)) > 0)
+        {
+            hash = fnv1a(buffer, size, hash);
+        }
+
+        std::fclose(file);
+
+        return hash;
+    }
+
+    size_t alignUp(size_t offset)
+    {
+        return (offset + CACHE_ALIGNMENT - 1) & ~(CACHE_ALIGNMENT - 1);
+    }
+
+    bool writePadding(FILE* file, size_t& offset)
+    {
+        static constexpr uint8_t zeros[CACHE_ALIGNMENT] = {};
+
+        const size_t padding = alignUp(offset) - offset;
+        offset += padding;
+
+        return padding == 0 || std::fwrite(zeros, padding, 1, file) == 1;
+    }
+
+    bool writeBytes(FILE* file, size_t& offset, const void* data, size_t size)
+    {
+        offset += size;
+        return size == 0 || std::fwrite(data, size, 1, file) == 1;
+    }
+}
+
+
+std::optional<MeshCache> MeshCache::open(std::string_view sourcePath)
+{
+    const std::string path = cachePath(sourcePath);
+    const int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd == -1)
+    {
+        return std::nullopt;
+    }
+
+    struct stat info;
+
+    if (fstat(fd, &info) != 0 || static_cast<size_t>(info.st_size) < sizeof(CacheHeader))
+    {
+        ::close(fd);
+        return std::nullopt;
+    }
+
+    void* data = mmap(nullptr, info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    if (data == MAP_FAILED)
+    {
+        logWarning("Failed to map mesh cache: {}", path);
+        return std::nullopt;
+    }
+
+    MeshCache cache;
+
+    cache.m_data = static_cast<const uint8_t*>(data);
+    cache.m_size = info.st_size;
+
+    CacheHeader header;
+    std::memcpy(&header, cache.m_data, sizeof(header));
+
+    if (std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) != 0 || header.version != CACHE_VERSION)
+    {
+        logInfo("Mesh cache is outdated: {}", path);
+        return std::nullopt;
+    }
+
+    const std::optional<SourceInfo> source = statSource(sourcePath);
+
+    if (!source || source->size != header.sourceSize)
+    {
+        return std::nullopt;
+    }
+
+    if (source->mtime != header.sourceMtime && hashSource(sourcePath) != header.sourceHash)
+    {
+        logInfo("Mesh cache is stale: {}", path);
+        return std::nullopt;
+    }
+
+    if (!cache.parse())
+    {
+        logWarning("Mesh cache is corrupt: {}", path);
+        return std::nullopt;
+    }
+
+    return std::make_optional(std::move(cache));
+}
+
+bool MeshCache::write(std::string_view sourcePath, const std::vector<MeshData>& meshes, VertexFormat format, const VertexQuantization& quantization)
+{
+    const std::optional<SourceInfo> source = statSource(sourcePath);
+    const std::optional<uint64_t> hash = hashSource(sourcePath);
+
+    if (!source || !hash)
+    {
+        return false;
+    }
+
+    const std::string path = cachePath(sourcePath);
+    const std::string temporaryPath = path + ".tmp";
+
+    FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        logWarning("Failed to create mesh cache: {}", path);
+        return false;
+    }
+
+    CacheHeader header;
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.meshCount = static_cast<uint32_t>(meshes.size());
+    header.sourceSize = source->size;
+    header.sourceMtime = source->mtime;
+    header.sourceHash = *hash;
+    header.vertexFormat = static_cast<uint32_t>(format);
+    header.reserved = 0;
+    std::memcpy(header.quantizationOffset, &quantization.offset, sizeof(header.quantizationOffset));
+    std::memcpy(header.quantizationScale, &quantization.scale, sizeof(header.quantizationScale));
+
+    size_t offset = 0;
+    bool result = writeBytes(file, offset, &header, sizeof(header));
+
+    std::vector<PackedVertex> packed;
+
+    for (const MeshData& mesh : meshes)
+    {
+        const MeshRecord record
+        {
+            static_cast<uint32_t>(mesh.vertices.size()),
+            static_cast<uint32_t>(mesh.indices.size()),
+            static_cast<uint32_t>(mesh.textures.size()),
+            static_cast<uint32_t>(mesh.lods.size())
+        };
+
+        result = result && writeBytes(file, offset, &record, sizeof(record));
+
+        for (const Texture& texture : mesh.textures)
+        {
+            const TextureRecord textureRecord { static_cast<uint32_t>(texture.type), static_cast<uint32_t>(texture.file.size()) };
+
+            result = result && writeBytes(file, offset, &textureRecord, sizeof(textureRecord));
+            result = result && writeBytes(file, offset, texture.file.data(), texture.file.size());
+        }
+
+        result = result && writePadding(file, offset);
+        result = result && writeBytes(file, offset, mesh.lods.data(), mesh.lods.size() * sizeof(MeshLod));
+        result = result && writePadding(file, offset);
+
+        if (format == VertexFormat::Packed)
+        {
+            packed.clear();
+
+            for (const Vertex& vertex : mesh.vertices)
+            {
+                packed.push_back(packVertex(vertex, quantization));
+            }
+
+            result = result && writeBytes(file, offset, packed.data(), packed.size() * sizeof(PackedVertex));
+        }
+        else
+        {
+            result = result && writeBytes(file, offset, mesh.vertices.data(), mesh.vertices.size() * sizeof(Vertex));
+        }
+
+        result = result && writePadding(file, offset);
+        result = result && writeBytes(file, offset, mesh.indices.data(), mesh.indices.size() * sizeof(uint32_t));
+        result = result && writePadding(file, offset);
+    }
+
+    result = (std::fclose(file) == 0) && result;
+
+    if (!result || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        logWarning("Failed to write mesh cache: {}", path);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+MeshCache::~MeshCache()
+{
+    if (m_data != nullptr)
+    {
+        munmap(const_cast<uint8_t*>(m_data), m_size);
+    }
+}
+
+MeshCache::MeshCache(MeshCache&& other) noexcept
+{
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_format, other.m_format);
+    std::swap(m_quantization, other.m_quantization);
+    std::swap(m_meshes, other.m_meshes);
+}
+
+MeshCache& MeshCache::operator=(MeshCache&& other) noexcept
+{
+    std::swap(m_data, other.m_data);
+    std::swap(m_size, other.m_size);
+    std::swap(m_format, other.m_format);
+    std::swap(m_quantization, other.m_quantization);
+    std::swap(m_meshes, other.m_meshes);
+
+    return *this;
+}
+
+const std::vector<MeshCache::MeshView>& MeshCache::getMeshes() const
+{
+    return m_meshes;
+}
+
+VertexFormat MeshCache::getVertexFormat() const
+{
+    return m_format;
+}
+
+const VertexQuantization& MeshCache::getQuantization() const
+{
+    return m_quantization;
+}
+
+bool MeshCache::parse()
+{
+    CacheHeader header;
+    std::memcpy(&header, m_data, sizeof(header));
+
+    size_t offset = sizeof(header);
+
+    if (header.vertexFormat > static_cast<uint32_t>(VertexFormat::Packed))
+    {
+        return false;
+    }
+
+    m_format = static_cast<VertexFormat>(header.vertexFormat);
+    std::memcpy(&m_quantization.offset, header.quantizationOffset, sizeof(header.quantizationOffset));
+    std::memcpy(&m_quantization.scale, header.quantizationScale, sizeof(header.quantizationScale));
+
+    const size_t stride = getVertexStride(m_format);
+
+    auto take = [this, &offset](size_t size) -> const uint8_t*
+    {
+        if (offset > m_size || size > m_size - offset)
+        {
+            return nullptr;
+        }
+
+        const uint8_t* pointer = m_data + offset;
+        offset += size;
+
+        return pointer;
+    };
+
+    m_meshes.reserve(header.meshCount);
+
+    for (uint32_t meshIdx = 0; meshIdx < header.meshCount; ++meshIdx)
+    {
+        const uint8_t* recordData = take(sizeof(MeshRecord));
+
+        if (recordData == nullptr)
+        {
+            return false;
+        }
+
+        MeshRecord record;
+        std::memcpy(&record, recordData, sizeof(record));
+
+        MeshView view;
+        view.textures.reserve(record.textureCount);
+
+        for (uint32_t textureIdx = 0; textureIdx < record.textureCount; ++textureIdx)
+        {
+            const uint8_t* textureData = take(sizeof(TextureRecord));
+
+            if (textureData == nullptr)
+            {
+                return false;
+            }
+
+            TextureRecord textureRecord;
+            std::memcpy(&textureRecord, textureData, sizeof(textureRecord));
+
+            const uint8_t* name = take(textureRecord.length);
+
+            if (name == nullptr || textureRecord.type > static_cast<uint32_t>(Texture::Type::Height))
+            {
+                return false;
+            }
+
+            view.textures.push_back({ static_cast<Texture::Type>(textureRecord.type), std::string_view(reinterpret_cast<const char*>(name), textureRecord.length) });
+        }
+
+        offset = alignUp(offset);
+        const uint8_t* lods = take(static_cast<size_t>(record.lodCount) * sizeof(MeshLod));
+
+        offset = alignUp(offset);
+        const uint8_t* vertices = take(static_cast<size_t>(record.vertexCount) * stride);
+
+        offset = alignUp(offset);
+        const uint8_t* indices = take(static_cast<size_t>(record.indexCount) * sizeof(uint32_t));
+
+        offset = alignUp(offset);
+
+        if (lods == nullptr || vertices == nullptr || indices == nullptr || offset > m_size)
+        {
+            return false;
+        }
+
+        view.lods = std::span(reinterpret_cast<const MeshLod*>(lods), record.lodCount);
+
+        if (m_format == VertexFormat::Packed)
+        {
+            view.packedVertices = std::span(reinterpret_cast<const PackedVertex*>(vertices), record.vertexCount);
+        }
+        else
+        {
+            view.vertices = std::span(reinterpret_cast<const Vertex*>(vertices), record.vertexCount);
+        }
+
+        view.indices = std::span(reinterpret_cast<const uint32_t*>(indices), record.indexCount);
+
+        for (const MeshLod& lod : view.lods)
+        {
+            if (lod.firstIndex > record.indexCount || lod.indexCount > record.indexCount - lod.firstIndex)
+            {
+                return false;
+            }
+        }
+
+        m_meshes.push_back(std::move(view));
+    }
+
+    return true;
+}
\ No newline at end of file
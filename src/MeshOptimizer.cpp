@@ -0,0 +1,382 @@
+#include "MeshOptimizer.hpp"
+
+#include <cmath>
+#include <numeric>
+#include <algorithm>
+
+
+namespace
+{
+    // Size of the FIFO cache used for statistics and overdraw clustering;
+    // matches the post-transform cache of most desktop GPUs.
+    constexpr size_t SIMULATED_CACHE_SIZE = 16;
+
+    // Forsyth scoring parameters.
+    constexpr size_t SCORED_CACHE_SIZE = 32;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+
+    float vertexScore(int32_t cachePosition, uint32_t remainingValence)
+    {
+        if (remainingValence == 0)
+        {
+            return -1.0f;
+        }
+
+        float score = 0.0f;
+
+        if (cachePosition >= 0)
+        {
+            if (cachePosition < 3)
+            {
+                // The triangle just emitted; it gains nothing from staying.
+                score = LAST_TRIANGLE_SCORE;
+            }
+            else
+            {
+                const float scale = 1.0f / static_cast<float>(SCORED_CACHE_SIZE - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scale, CACHE_DECAY_POWER);
+            }
+        }
+
+        // Favour vertices with few triangles left so they get finished off.
+        return score + VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingValence), -VALENCE_BOOST_POWER);
+    }
+
+    // Simulates a FIFO cache and calls onTriangle(triangle, misses) for every
+    // triangle.
+    template <typename Callback>
+    void simulateCache(std::span<const uint32_t> indices, size_t vertexCount, std::pmr::memory_resource* scratch, Callback onTriangle)
+    {
+        std::pmr::vector<uint32_t> insertedAt(vertexCount, 0, scratch);
+        uint32_t timestamp = SIMULATED_CACHE_SIZE + 1;
+
+        for (size_t idx = 0; idx + 2 < indices.size(); idx += 3)
+        {
+            uint32_t misses = 0;
+
+            for (size_t corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t vertex = indices[idx + corner];
+
+                if (timestamp - insertedAt[vertex] > SIMULATED_CACHE_SIZE)
+                {
+                    insertedAt[vertex] = timestamp++;
+                    ++misses;
+                }
+            }
+
+            onTriangle(idx / 3, misses);
+        }
+    }
+}
+
+
+float VertexCacheStats::getAcmr() const
+{
+    return triangleCount == 0 ? 0.0f : static_cast<float>(missCount) / static_cast<float>(triangleCount);
+}
+
+float VertexCacheStats::getAtvr() const
+{
+    return vertexCount == 0 ? 0.0f : static_cast<float>(missCount) / static_cast<float>(vertexCount);
+}
+
+VertexCacheStats& VertexCacheStats::operator+=(const VertexCacheStats& other)
+{
+    triangleCount += other.triangleCount;
+    vertexCount += other.vertexCount;
+    missCount += other.missCount;
+
+    return *this;
+}
+
+VertexCacheStats analyzeVertexCache(std::span<const uint32_t> indices, size_t vertexCount, std::pmr::memory_resource* scratch)
+{
+    VertexCacheStats stats;
+    stats.triangleCount = static_cast<uint32_t>(indices.size() / 3);
+
+    std::pmr::vector<uint8_t> referenced(vertexCount, 0, scratch);
+
+    for (const uint32_t vertex : indices)
+    {
+        stats.vertexCount += referenced[vertex] == 0;
+        referenced[vertex] = 1;
+    }
+
+    simulateCache(indices, vertexCount, scratch, [&stats](size_t, uint32_t misses) { stats.missCount += misses; });
+
+    return stats;
+}
+
+void optimizeVertexCache(std::span<uint32_t> indices, size_t vertexCount, std::pmr::memory_resource* scratch)
+{
+    const size_t triangleCount = indices.size() / 3;
+
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // Vertex -> triangle adjacency; the first liveCount entries of a vertex's
+    // list are the triangles not yet emitted.
+    std::pmr::vector<uint32_t> offsets(vertexCount + 1, 0, scratch);
+
+    for (size_t idx = 0; idx < triangleCount * 3; ++idx)
+    {
+        ++offsets[indices[idx] + 1];
+    }
+
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+
+    std::pmr::vector<uint32_t> adjacency(triangleCount * 3, scratch);
+    std::pmr::vector<uint32_t> liveCount(vertexCount, 0, scratch);
+
+    for (size_t idx = 0; idx < triangleCount * 3; ++idx)
+    {
+        const uint32_t vertex = indices[idx];
+        adjacency[offsets[vertex] + liveCount[vertex]++] = static_cast<uint32_t>(idx / 3);
+    }
+
+    std::pmr::vector<int32_t> cachePosition(vertexCount, -1, scratch);
+    std::pmr::vector<float> scores(vertexCount, scratch);
+
+    for (size_t vertex = 0; vertex < vertexCount; ++vertex)
+    {
+        scores[vertex] = vertexScore(-1, liveCount[vertex]);
+    }
+
+    std::pmr::vector<float> triangleScores(triangleCount, scratch);
+    std::pmr::vector<uint8_t> emitted(triangleCount, 0, scratch);
+
+    uint32_t best = 0;
+
+    for (size_t triangle = 0; triangle < triangleCount; ++triangle)
+    {
+        const uint32_t* corners = &indices[triangle * 3];
+        triangleScores[triangle] = scores[corners[0]] + scores[corners[1]] + scores[corners[2]];
+
+        if (triangleScores[triangle] > triangleScores[best])
+        {
+            best = static_cast<uint32_t>(triangle);
+        }
+    }
+
+    std::pmr::vector<uint32_t> result(scratch);
+    result.reserve(triangleCount * 3);
+
+    std::pmr::vector<uint32_t> cache(scratch);
+    std::pmr::vector<uint32_t> nextCache(scratch);
+    size_t cursor = 0;
+
+    while (result.size() < triangleCount * 3)
+    {
+        if (best == UINT32_MAX)
+        {
+            // Nothing in the cache has triangles left; resume with the next
+            // unemitted triangle in input order.
+            while (emitted[cursor])
+            {
+                ++cursor;
+            }
+
+            best = static_cast<uint32_t>(cursor);
+        }
+
+        const uint32_t corners[3] = { indices[best * 3], indices[best * 3 + 1], indices[best * 3 + 2] };
+
+        emitted[best] = 1;
+        result.insert(result.end(), corners, corners + 3);
+
+        nextCache.assign(corners, corners + 3);
+
+        for (const uint32_t vertex : corners)
+        {
+            uint32_t* live = &adjacency[offsets[vertex]];
+            *std::find(live, live + liveCount[vertex], best) = live[liveCount[vertex] - 1];
+            --liveCount[vertex];
+        }
+
+        for (const uint32_t vertex : cache)
+        {
+            if (vertex != corners[0] && vertex != corners[1] && vertex != corners[2])
+            {
+                nextCache.push_back(vertex);
+            }
+        }
+
+        for (size_t position = 0; position < nextCache.size(); ++position)
+        {
+            const uint32_t vertex = nextCache[position];
+
+            cachePosition[vertex] = position < SCORED_CACHE_SIZE ? static_cast<int32_t>(position) : -1;
+            scores[vertex] = vertexScore(cachePosition[vertex], liveCount[vertex]);
+        }
+
+        best = UINT32_MAX;
+        float bestScore = -1.0f;
+
+        for (const uint32_t vertex : nextCache)
+        {
+            for (uint32_t adj = offsets[vertex]; adj < offsets[vertex] + liveCount[vertex]; ++adj)
+            {
+                const uint32_t triangle = adjacency[adj];
+                const uint32_t* triangleCorners = &indices[triangle * 3];
+
+                triangleScores[triangle] = scores[triangleCorners[0]] + scores[triangleCorners[1]] + scores[triangleCorners[2]];
+
+                if (triangleScores[triangle] > bestScore)
+                {
+                    best = triangle;
+                    bestScore = triangleScores[triangle];
+                }
+            }
+        }
+
+        nextCache.resize(std::min(nextCache.size(), SCORED_CACHE_SIZE));
+        std::swap(cache, nextCache);
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimizeOverdraw(std::span<uint32_t> indices, std::span<const Vertex> vertices, std::pmr::memory_resource* scratch)
+{
+    const size_t triangleCount = indices.size() / 3;
+
+    if (triangleCount == 0)
+    {
+        return;
+    }
+
+    // A triangle missing on all three vertices starts a cluster.
+    std::pmr::vector<uint32_t> clusterStarts(scratch);
+
+    simulateCache(indices, vertices.size(), scratch, [&clusterStarts](size_t triangle, uint32_t misses)
+    {
+        if (triangle == 0 || misses == 3)
+        {
+            clusterStarts.push_back(static_cast<uint32_t>(triangle));
+        }
+    });
+
+    if (clusterStarts.size() < 2)
+    {
+        return;
+    }
+
+    clusterStarts.push_back(static_cast<uint32_t>(triangleCount));
+
+    glm::vec3 meshCentroid(0.0f);
+
+    for (const uint32_t vertex : indices)
+    {
+        meshCentroid += vertices[vertex].position;
+    }
+
+    meshCentroid /= static_cast<float>(indices.size());
+
+    const size_t clusterCount = clusterStarts.size() - 1;
+    std::pmr::vector<float> sortKeys(clusterCount, scratch);
+
+    for (size_t cluster = 0; cluster < clusterCount; ++cluster)
+    {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);
+        float area = 0.0f;
+
+        for (uint32_t triangle = clusterStarts[cluster]; triangle < clusterStarts[cluster + 1]; ++triangle)
+        {
+            const glm::vec3& p0 = vertices[indices[triangle * 3]].position;
+            const glm::vec3& p1 = vertices[indices[triangle * 3 + 1]].position;
+            const glm::vec3& p2 = vertices[indices[triangle * 3 + 2]].position;
+
+            const glm::vec3 weightedNormal = glm::cross(p1 - p0, p2 - p0);
+            const float weight = glm::length(weightedNormal);
+
+            centroid += (p0 + p1 + p2) * (weight / 3.0f);
+            normal += weightedNormal;
+            area += weight;
+        }
+
+        const float normalLength = glm::length(normal);
+
+        if (area <= 0.0f || normalLength <= 0.0f)
+        {
+            sortKeys[cluster] = 0.0f;
+            continue;
+        }
+
+        // Clusters facing away from the centre are on the outside and tend to
+        // occlude the rest.
+        sortKeys[cluster] = glm::dot(centroid / area - meshCentroid, normal / normalLength);
+    }
+
+    std::pmr::vector<uint32_t> order(clusterCount, scratch);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&sortKeys](uint32_t lhs, uint32_t rhs) { return sortKeys[lhs] > sortKeys[rhs]; });
+
+    std::pmr::vector<uint32_t> result(scratch);
+    result.reserve(indices.size());
+
+    for (const uint32_t cluster : order)
+    {
+        result.insert(result.end(), indices.begin() + clusterStarts[cluster] * 3, indices.begin() + clusterStarts[cluster + 1] * 3);
+    }
+
+    std::copy(result.begin(), result.end(), indices.begin());
+}
+
+void optimizeVertexFetch(std::vector<Vertex>& vertices, std::span<uint32_t> indices, std::pmr::memory_resource* scratch)
+{
+    std::pmr::vector<uint32_t> remap(vertices.size(), UINT32_MAX, scratch);
+    std::vector<Vertex> result;
+    result.reserve(vertices.size());
+
+    for (uint32_t& index : indices)
+    {
+        if (remap[index] == UINT32_MAX)
+        {
+            remap[index] = static_cast<uint32_t>(result.size());
+            result.push_back(vertices[index]);
+        }
+
+        index = remap[index];
+    }
+
+    vertices = std::move(result);
+}
+
+MeshOptimizeStats optimizeMesh(MeshData& mesh, bool sortForOverdraw, std::pmr::memory_resource* scratch)
+{
+    MeshOptimizeStats stats;
+
+    if (mesh.lods.empty())
+    {
+        mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+    }
+
+    const std::span<const uint32_t> baseIndices(mesh.indices.data(), mesh.lods.front().indexCount);
+    stats.before = analyzeVertexCache(baseIndices, mesh.vertices.size(), scratch);
+
+    for (const MeshLod& lod : mesh.lods)
+    {
+        const std::span<uint32_t> range(mesh.indices.data() + lod.firstIndex, lod.indexCount);
+
+        optimizeVertexCache(range, mesh.vertices.size(), scratch);
+
+        if (sortForOverdraw)
+        {
+            optimizeOverdraw(range, mesh.vertices, scratch);
+        }
+    }
+
+    // LOD 0 comes first in the index buffer, so it gets the linear fetch order.
+    optimizeVertexFetch(mesh.vertices, mesh.indices, scratch);
+
+    stats.after = analyzeVertexCache(baseIndices, mesh.vertices.size(), scratch);
+
+    return stats;
+}
\ No newline at end of file
@@ -0,0 +1,414 @@
+#include "MeshSimplifier.hpp"
+
+#include <cmath>
+#include <cstring>
+#include <numeric>
+#include <algorithm>
+#include <unordered_map>
+
+
+namespace
+{
+    constexpr size_t MAX_LOD_COUNT = 5;
+    constexpr size_t MIN_LOD_INDEX_COUNT = 3 * 64;
+    constexpr float MIN_LOD_REDUCTION = 0.9f;
+    constexpr double BORDER_WEIGHT = 10.0;
+
+    struct Quadric
+    {
+        double a2 = 0, ab = 0, ac = 0, ad = 0;
+        double b2 = 0, bc = 0, bd = 0;
+        double c2 = 0, cd = 0;
+        double d2 = 0;
+
+        static Quadric fromPlane(const glm::vec3& normal, float distance, double weight)
+        {
+            const double a = normal.x;
+            const double b = normal.y;
+            const double c = normal.z;
+            const double d = distance;
+
+            return Quadric
+            {
+                a * a * weight, a * b * weight, a * c * weight, a * d * weight,
+                b * b * weight, b * c * weight, b * d * weight,
+                c * c * weight, c * d * weight,
+                d * d * weight
+            };
+        }
+
+        void add(const Quadric& other)
+        {
+            a2 += other.a2; ab += other.ab; ac += other.ac; ad += other.ad;
+            b2 += other.b2; bc += other.bc; bd += other.bd;
+            c2 += other.c2; cd += other.cd;
+            d2 += other.d2;
+        }
+
+        double evaluate(const glm::vec3& point) const
+        {
+            const double x = point.x;
+            const double y = point.y;
+            const double z = point.z;
+
+            const double error = a2 * x * x + 2 * ab * x * y + 2 * ac * x * z + 2 * ad * x
+                + b2 * y * y + 2 * bc * y * z + 2 * bd * y
+                + c2 * z * z + 2 * cd * z
+                + d2;
+
+            return std::max(error, 0.0);
+        }
+    };
+
+    struct PositionHash
+    {
+        size_t operator()(const glm::vec3& position) const
+        {
+            uint32_t bits[3];
+            std::memcpy(bits, &position, sizeof(bits));
+
+            return (bits[0] * 73856093u) ^ (bits[1] * 19349663u) ^ (bits[2] * 83492791u);
+        }
+    };
+
+    struct Collapse
+    {
+        uint32_t from;
+        uint32_t to;
+        double cost;
+    };
+
+    uint64_t edgeKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? (uint64_t(a) << 32) | b : (uint64_t(b) << 32) | a;
+    }
+
+    bool hasSameAttributes(const Vertex& lhs, const Vertex& rhs)
+    {
+        return lhs.normal == rhs.normal && lhs.texCoords == rhs.texCoords;
+    }
+}
+
+
+std::pmr::vector<uint32_t> simplifyMesh(std::span<const Vertex> vertices, std::span<const uint32_t> indices, size_t targetIndexCount, float& resultError, std::pmr::memory_resource* scratch)
+{
+    std::pmr::vector<uint32_t> result(indices.begin(), indices.end(), scratch);
+    resultError = 0.0f;
+
+    // Weld vertices by position so collapses see the real topology, not the
+    // per-corner vertices OBJ import produces.
+    std::pmr::unordered_map<glm::vec3, uint32_t, PositionHash> classByPosition(scratch);
+    classByPosition.reserve(vertices.size());
+    std::pmr::vector<uint32_t> classOf(vertices.size(), scratch);
+    std::pmr::vector<glm::vec3> positions(scratch);
+
+    for (size_t idx = 0; idx < vertices.size(); ++idx)
+    {
+        auto [it, inserted] = classByPosition.try_emplace(vertices[idx].position, static_cast<uint32_t>(positions.size()));
+
+        if (inserted)
+        {
+            positions.push_back(vertices[idx].position);
+        }
+
+        classOf[idx] = it->second;
+    }
+
+    const size_t classCount = positions.size();
+
+    // A position is a seam only where its vertices disagree on normal or UV;
+    // duplicates that merely have different indices collapse as one.
+    std::pmr::vector<uint32_t> classVertex(classCount, UINT32_MAX, scratch);
+    std::pmr::vector<uint8_t> isSeam(classCount, 0, scratch);
+
+    for (const uint32_t vertex : result)
+    {
+        uint32_t& representative = classVertex[classOf[vertex]];
+
+        if (representative == UINT32_MAX)
+        {
+            representative = vertex;
+        }
+        else if (representative != vertex && !hasSameAttributes(vertices[representative], vertices[vertex]))
+        {
+            isSeam[classOf[vertex]] = 1;
+        }
+    }
+
+    std::pmr::vector<Quadric> quadrics(classCount, scratch);
+    std::pmr::unordered_map<uint64_t, uint32_t> edgeUse(scratch);
+    edgeUse.reserve(result.size());
+
+    for (size_t idx = 0; idx + 2 < result.size(); idx += 3)
+    {
+        const uint32_t c[3] = { classOf[result[idx]], classOf[result[idx + 1]], classOf[result[idx + 2]] };
+        const glm::vec3 normal = glm::cross(positions[c[1]] - positions[c[0]], positions[c[2]] - positions[c[0]]);
+        const float length = glm::length(normal);
+
+        if (length <= 0.0f)
+        {
+            continue;
+        }
+
+        const glm::vec3 unitNormal = normal / length;
+        const Quadric plane = Quadric::fromPlane(unitNormal, -glm::dot(unitNormal, positions[c[0]]), 1.0);
+
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            quadrics[c[corner]].add(plane);
+            ++edgeUse[edgeKey(c[corner], c[(corner + 1) % 3])];
+        }
+    }
+
+    // Open borders get a plane perpendicular to their face so they are not
+    // pulled inwards.
+    for (size_t idx = 0; idx + 2 < result.size(); idx += 3)
+    {
+        const uint32_t c[3] = { classOf[result[idx]], classOf[result[idx + 1]], classOf[result[idx + 2]] };
+        const glm::vec3 normal = glm::cross(positions[c[1]] - positions[c[0]], positions[c[2]] - positions[c[0]]);
+
+        for (int corner = 0; corner < 3; ++corner)
+        {
+            const uint32_t a = c[corner];
+            const uint32_t b = c[(corner + 1) % 3];
+
+            if (edgeUse[edgeKey(a, b)] != 1)
+            {
+                continue;
+            }
+
+            const glm::vec3 borderNormal = glm::cross(positions[b] - positions[a], normal);
+            const float length = glm::length(borderNormal);
+
+            if (length <= 0.0f)
+            {
+                continue;
+            }
+
+            const glm::vec3 unitNormal = borderNormal / length;
+            const Quadric plane = Quadric::fromPlane(unitNormal, -glm::dot(unitNormal, positions[a]), BORDER_WEIGHT);
+
+            quadrics[a].add(plane);
+            quadrics[b].add(plane);
+        }
+    }
+
+    std::pmr::vector<uint32_t> adjacencyOffsets(classCount + 1, scratch);
+    std::pmr::vector<uint32_t> adjacency(scratch);
+    std::pmr::vector<uint8_t> locked(classCount, scratch);
+    std::pmr::vector<Collapse> collapses(scratch);
+    std::pmr::vector<uint32_t> fill(scratch);
+    std::pmr::vector<uint32_t> classTarget(classCount, scratch);
+
+    double maxCost = 0.0;
+
+    while (result.size() > targetIndexCount)
+    {
+        // Class -> triangle adjacency of the current index buffer.
+        std::fill(adjacencyOffsets.begin(), adjacencyOffsets.end(), 0);
+
+        for (const uint32_t vertex : result)
+        {
+            ++adjacencyOffsets[classOf[vertex] + 1];
+        }
+
+        std::partial_sum(adjacencyOffsets.begin(), adjacencyOffsets.end(), adjacencyOffsets.begin());
+        adjacency.resize(result.size());
+
+        fill.assign(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+
+        for (size_t idx = 0; idx < result.size(); ++idx)
+        {
+            adjacency[fill[classOf[result[idx]]]++] = static_cast<uint32_t>(idx / 3);
+        }
+
+        collapses.clear();
+
+        for (size_t idx = 0; idx + 2 < result.size(); idx += 3)
+        {
+            for (int corner = 0; corner < 3; ++corner)
+            {
+                const uint32_t a = classOf[result[idx + corner]];
+                const uint32_t b = classOf[result[idx + (corner + 1) % 3]];
+
+                // Each interior edge is seen from both triangles; keep one.
+                if (a > b && edgeUse[edgeKey(a, b)] > 1)
+                {
+                    continue;
+                }
+
+                Quadric merged = quadrics[a];
+                merged.add(quadrics[b]);
+
+                const double costAB = isSeam[a] ? INFINITY : merged.evaluate(positions[b]);
+                const double costBA = isSeam[b] ? INFINITY : merged.evaluate(positions[a]);
+
+                if (std::isinf(costAB) && std::isinf(costBA))
+                {
+                    continue;
+                }
+
+                collapses.push_back(costAB <= costBA ? Collapse { a, b, costAB } : Collapse { b, a, costBA });
+            }
+        }
+
+        std::sort(collapses.begin(), collapses.end(), [](const Collapse& lhs, const Collapse& rhs) { return lhs.cost < rhs.cost; });
+
+        std::fill(locked.begin(), locked.end(), 0);
+        std::fill(classTarget.begin(), classTarget.end(), UINT32_MAX);
+
+        const size_t collapsesNeeded = (result.size() - targetIndexCount) / 6 + 1;
+        size_t collapsed = 0;
+
+        for (const Collapse& collapse : collapses)
+        {
+            if (collapsed >= collapsesNeeded)
+            {
+                break;
+            }
+
+            if (locked[collapse.from] || locked[collapse.to])
+            {
+                continue;
+            }
+
+            uint32_t sourceVertex = UINT32_MAX;
+            uint32_t targetVertex = UINT32_MAX;
+            bool flips = false;
+
+            for (uint32_t adj = adjacencyOffsets[collapse.from]; adj < adjacencyOffsets[collapse.from + 1] && !flips; ++adj)
+            {
+                const uint32_t* triangle = &result[adjacency[adj] * 3];
+                const uint32_t c[3] = { classOf[triangle[0]], classOf[triangle[1]], classOf[triangle[2]] };
+
+                if (c[0] == collapse.to || c[1] == collapse.to || c[2] == collapse.to)
+                {
+                    for (int corner = 0; corner < 3; ++corner)
+                    {
+                        if (c[corner] == collapse.from)
+                        {
+                            sourceVertex = triangle[corner];
+                        }
+                        else if (c[corner] == collapse.to)
+                        {
+                            targetVertex = triangle[corner];
+                        }
+                    }
+
+                    continue;
+                }
+
+                // Reject the collapse if any surviving triangle would flip.
+                glm::vec3 before[3] = { positions[c[0]], positions[c[1]], positions[c[2]] };
+                glm::vec3 after[3] = { before[0], before[1], before[2] };
+
+                for (int corner = 0; corner < 3; ++corner)
+                {
+                    if (c[corner] == collapse.from)
+                    {
+                        after[corner] = positions[collapse.to];
+                    }
+                }
+
+                const glm::vec3 normalBefore = glm::cross(before[1] - before[0], before[2] - before[0]);
+                const glm::vec3 normalAfter = glm::cross(after[1] - after[0], after[2] - after[0]);
+
+                flips = glm::dot(normalBefore, normalAfter) <= 0.0f;
+            }
+
+            if (flips || sourceVertex == UINT32_MAX || targetVertex == UINT32_MAX)
+            {
+                continue;
+            }
+
+            // The source class is not a seam, so every vertex of it can take
+            // the target vertex.
+            classTarget[collapse.from] = targetVertex;
+            quadrics[collapse.to].add(quadrics[collapse.from]);
+            maxCost = std::max(maxCost, collapse.cost);
+            ++collapsed;
+
+            // Lock the one-ring of both ends; the cached costs and flip tests
+            // around them are stale until the next pass.
+            for (const uint32_t cls : { collapse.from, collapse.to })
+            {
+                for (uint32_t adj = adjacencyOffsets[cls]; adj < adjacencyOffsets[cls + 1]; ++adj)
+                {
+                    const uint32_t* triangle = &result[adjacency[adj] * 3];
+
+                    locked[classOf[triangle[0]]] = 1;
+                    locked[classOf[triangle[1]]] = 1;
+                    locked[classOf[triangle[2]]] = 1;
+                }
+            }
+        }
+
+        if (collapsed == 0)
+        {
+            break;
+        }
+
+        const auto remapVertex = [&](uint32_t vertex)
+        {
+            const uint32_t target = classTarget[classOf[vertex]];
+            return target != UINT32_MAX ? target : vertex;
+        };
+
+        size_t writeIdx = 0;
+
+        for (size_t idx = 0; idx + 2 < result.size(); idx += 3)
+        {
+            const uint32_t a = remapVertex(result[idx]);
+            const uint32_t b = remapVertex(result[idx + 1]);
+            const uint32_t c = remapVertex(result[idx + 2]);
+
+            if (classOf[a] == classOf[b] || classOf[b] == classOf[c] || classOf[c] == classOf[a])
+            {
+                continue;
+            }
+
+            result[writeIdx++] = a;
+            result[writeIdx++] = b;
+            result[writeIdx++] = c;
+        }
+
+        result.resize(writeIdx);
+    }
+
+    resultError = static_cast<float>(std::sqrt(maxCost));
+
+    return result;
+}
+
+void generateLods(MeshData& mesh, std::pmr::memory_resource* scratch)
+{
+    mesh.lods.clear();
+    mesh.lods.push_back({ 0, static_cast<uint32_t>(mesh.indices.size()), 0.0f });
+
+    std::pmr::vector<uint32_t> current(mesh.indices.begin(), mesh.indices.end(), scratch);
+
+    while (mesh.lods.size() < MAX_LOD_COUNT)
+    {
+        const size_t target = (current.size() / 2) / 3 * 3;
+
+        if (target < MIN_LOD_INDEX_COUNT)
+        {
+            break;
+        }
+
+        float error = 0.0f;
+        std::pmr::vector<uint32_t> simplified = simplifyMesh(mesh.vertices, current, target, error, scratch);
+
+        if (simplified.size() > current.size() * MIN_LOD_REDUCTION)
+        {
+            break;
+        }
+
+        const float lodError = std::max(error, mesh.lods.back().error);
+
+        mesh.lods.push_back({ static_cast<uint32_t>(mesh.indices.size()), static_cast<uint32_t>(simplified.size()), lodError });
+        mesh.indices.insert(mesh.indices.end(), simplified.begin(), simplified.end());
+
+        current = std::move(simplified);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,223 @@
+#include "MipChain.hpp"
+
+#include <cmath>
+#include <algorithm>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+
+namespace
+{
+    // Linear intensities are kept in 14 bits: enough to resolve the darkest
+    // sRGB steps while the inverse table stays small.
+    constexpr uint32_t LINEAR_MAX = (1u << 14) - 1;
+
+    struct GammaTables
+    {
+        uint16_t toLinear[256];
+        uint8_t fromLinear[LINEAR_MAX + 1];
+
+        GammaTables()
+        {
+            for (uint32_t value = 0; value < 256; ++value)
+            {
+                const float srgb = value / 255.0f;
+                const float linear = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+
+                toLinear[value] = static_cast<uint16_t>(std::lround(linear * LINEAR_MAX));
+            }
+
+            for (uint32_t value = 0; value <= LINEAR_MAX; ++value)
+            {
+                const float linear = static_cast<float>(value) / LINEAR_MAX;
+                const float srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+
+                fromLinear[value] = static_cast<uint8_t>(std::lround(std::clamp(srgb, 0.0f, 1.0f) * 255.0f));
+            }
+        }
+    };
+
+    const GammaTables& getGammaTables()
+    {
+        static const GammaTables tables;
+        return tables;
+    }
+
+    // Each downsampler fills destination texels [begin, width) of one row from
+    // the two source rows above it.
+    void downsampleRowScalar(const uint8_t* row0, const uint8_t* row1, uint32_t sourceWidth, uint8_t* destination, uint32_t begin, uint32_t width)
+    {
+        for (uint32_t x = begin; x < width; ++x)
+        {
+            const uint32_t x0 = 2 * x * 4;
+            const uint32_t x1 = std::min(2 * x + 1, sourceWidth - 1) * 4;
+
+            for (uint32_t channel = 0; channel < 4; ++channel)
+            {
+                const uint32_t sum = row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] + row1[x1 + channel];
+                destination[x * 4 + channel] = static_cast<uint8_t>((sum + 2) / 4);
+            }
+        }
+    }
+
+    void downsampleRowGamma(const uint8_t* row0, const uint8_t* row1, uint32_t sourceWidth, uint8_t* destination, uint32_t begin, uint32_t width)
+    {
+        const GammaTables& tables = getGammaTables();
+
+        for (uint32_t x = begin; x < width; ++x)
+        {
+            const uint32_t x0 = 2 * x * 4;
+            const uint32_t x1 = std::min(2 * x + 1, sourceWidth - 1) * 4;
+
+            for (uint32_t channel = 0; channel < 3; ++channel)
+            {
+                const uint32_t sum = tables.toLinear[row0[x0 + channel]] + tables.toLinear[row0[x1 + channel]] +
+                                     tables.toLinear[row1[x0 + channel]] + tables.toLinear[row1[x1 + channel]];
+
+                destination[x * 4 + channel] = tables.fromLinear[(sum + 2) / 4];
+            }
+
+            const uint32_t alpha = row0[x0 + 3] + row0[x1 + 3] + row1[x0 + 3] + row1[x1 + 3];
+            destination[x * 4 + 3] = static_cast<uint8_t>((alpha + 2) / 4);
+        }
+    }
+
+#ifdef __SSE2__
+    // Four destination texels per iteration: widen both rows to 16 bits, add
+    // them, then add horizontally adjacent texels (the two 64-bit halves).
+    // Returns the number of texels written; odd source widths leave the last
+    // texel to the scalar path.
+    uint32_t downsampleRowSse2(const uint8_t* row0, const uint8_t* row1, uint32_t sourceWidth, uint8_t* destination, uint32_t width)
+    {
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i rounding = _mm_set1_epi16(2);
+
+        const uint32_t count = std::min(width, sourceWidth / 2) & ~3u;
+
+        for (uint32_t x = 0; x < count; x += 4)
+        {
+            __m128i sums[2];
+
+            for (uint32_t half = 0; half < 2; ++half)
+            {
+                const size_t offset = (2 * x + 4 * half) * 4;
+
+                const __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + offset));
+                const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + offset));
+
+                const __m128i low = _mm_add_epi16(_mm_unpacklo_epi8(a, zero), _mm_unpacklo_epi8(b, zero));
+                const __m128i high = _mm_add_epi16(_mm_unpackhi_epi8(a, zero), _mm_unpackhi_epi8(b, zero));
+
+                const __m128i sum = _mm_add_epi16(_mm_unpacklo_epi64(low, high), _mm_unpackhi_epi64(low, high));
+
+                sums[half] = _mm_srli_epi16(_mm_add_epi16(sum, rounding), 2);
+            }
+
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(destination + x * 4), _mm_packus_epi16(sums[0], sums[1]));
+        }
+
+        return count;
+    }
+#endif
+
+    void downsample(const MipChain::Level& source, const MipChain::Level& target, uint8_t* data, bool srgb, bool vectorized)
+    {
+        const uint8_t* sourceData = data + source.offset;
+        uint8_t* targetData = data + target.offset;
+
+        for (uint32_t y = 0; y < target.height; ++y)
+        {
+            const uint8_t* row0 = sourceData + static_cast<size_t>(2 * y) * source.width * 4;
+            const uint8_t* row1 = sourceData + static_cast<size_t>(std::min(2 * y + 1, source.height - 1)) * source.width * 4;
+            uint8_t* destination = targetData + static_cast<size_t>(y) * target.width * 4;
+
+            if (srgb)
+            {
+                downsampleRowGamma(row0, row1, source.width, destination, 0, target.width);
+                continue;
+            }
+
+            uint32_t begin = 0;
+
+#ifdef __SSE2__
+            if (vectorized)
+            {
+                begin = downsampleRowSse2(row0, row1, source.width, destination, target.width);
+            }
+#else
+            static_cast<void>(vectorized);
+#endif
+
+            downsampleRowScalar(row0, row1, source.width, destination, begin, target.width);
+        }
+    }
+}
+
+
+MipChain buildMipChain(const uint8_t* pixels, uint32_t width, uint32_t height, uint32_t channels, bool srgb, bool vectorized)
+{
+    MipChain chain;
+    chain.width = width;
+    chain.height = height;
+
+    size_t size = 0;
+
+    for (uint32_t levelWidth = width, levelHeight = height;; levelWidth = std::max(1u, levelWidth / 2), levelHeight = std::max(1u, levelHeight / 2))
+    {
+        chain.levels.push_back({ size, levelWidth, levelHeight });
+        size += static_cast<size_t>(levelWidth) * levelHeight * 4;
+
+        if (levelWidth == 1 && levelHeight == 1)
+        {
+            break;
+        }
+    }
+
+    chain.data.resize(size);
+
+    const size_t texelCount = static_cast<size_t>(width) * height;
+
+    if (channels == 4)
+    {
+        std::copy(pixels, pixels + texelCount * 4, chain.data.begin());
+    }
+    else
+    {
+        for (size_t texel = 0; texel < texelCount; ++texel)
+        {
+            uint8_t* target = chain.data.data() + texel * 4;
+
+            for (uint32_t channel = 0; channel < 4; ++channel)
+            {
+                target[channel] = channel < channels ? pixels[texel * channels + channel] : (channel == 3 ? 255 : 0);
+            }
+        }
+    }
+
+    for (size_t level = 1; level < chain.levels.size(); ++level)
+    {
+        downsample(chain.levels[level - 1], chain.levels[level], chain.data.data(), srgb, vectorized);
+    }
+
+    return chain;
+}
+
+MipChain sliceMipChain(const MipChain& chain, uint32_t firstLevel)
+{
+    const MipChain::Level& base = chain.levels[firstLevel];
+
+    MipChain slice;
+    slice.width = base.width;
+    slice.height = base.height;
+    slice.data.assign(chain.data.begin() + base.offset, chain.data.end());
+
+    for (size_t level = firstLevel; level < chain.levels.size(); ++level)
+    {
+        const MipChain::Level& source = chain.levels[level];
+        slice.levels.push_back({ source.offset - base.offset, source.width, source.height });
+    }
+
+    return slice;
+}
\ No newline at end of file
@@ -1,57 +1,343 @@
 #include "Model.hpp"
 
 #include "Logger.hpp"
+#include "Profiler.hpp"
+#include "MeshCache.hpp"
+#include "MeshOptimizer.hpp"
+#include "ThreadPool.hpp"
+#include "ScratchArena.hpp"
+#include "TextureCache.hpp"
+#include "MeshSimplifier.hpp"
 
 #include <algorithm>
 
 
+namespace
+{
+    constexpr bool SORT_FOR_OVERDRAW = true;
+}
+
 
-std::optional<Model> Model::create(const std::string_view& path)
+std::optional<Model> Model::create(const std::string_view& path, const ModelLoadOptions& options)
 {
+    const VertexFormat format = options.vertexFormat;
+
+    Model model;
+
+    model.m_directory = path.substr(0, path.find_last_of('/'));
+
+    std::optional<MeshCache> cache = MeshCache::open(path);
+
+    if (cache && cache->getVertexFormat() != format)
+    {
+        logInfo("Mesh cache has a different vertex format, rebuilding: {}", path);
+        cache.reset();
+    }
+
+    if (cache)
+    {
+        size_t vertexCount = 0;
+        size_t indexCount = 0;
+
+        for (const MeshCache::MeshView& view : cache->getMeshes())
+        {
+            vertexCount += view.vertices.size() + view.packedVertices.size();
+            indexCount += view.indices.size();
+        }
+
+        const std::shared_ptr<GeometryArena> arena = GeometryArena::create(vertexCount, indexCount, format, cache->getQuantization());
+
+        for (const MeshCache::MeshView& view : cache->getMeshes())
+        {
+            std::vector<Texture> textures;
+
+            for (const MeshCache::TextureRef& ref : view.textures)
+            {
+                if (auto textureOpt = model.loadTexture(ref.file, ref.type))
+                {
+                    textures.push_back(*textureOpt);
+                }
+            }
+
+            if (format == VertexFormat::Packed)
+            {
+                model.m_meshes.emplace_back(Mesh::create(arena, view.packedVertices, view.indices, textures, view.lods, options.keepGeometry));
+            }
+            else
+            {
+                model.m_meshes.emplace_back(Mesh::create(arena, view.vertices, view.indices, textures, view.lods, options.keepGeometry));
+            }
+        }
+
+        TextureLoader::get().submit(std::move(model.m_textureRequests));
+        model.prepareDrawLists();
+
+        return std::make_optional(std::move(model));
+    }
+
     Assimp::Importer importer;
-    const aiScene* scene = importer.ReadFile(path.data(), aiProcess_Triangulate | aiProcess_FlipUVs);
+    const aiScene* scene = importer.ReadFile(path.data(), aiProcess_Triangulate | aiProcess_JoinIdenticalVertices | aiProcess_FlipUVs);
 
     if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode)
     {
-        log("Assimp error: ", importer.GetErrorString());
+        logError("Assimp error: {}", importer.GetErrorString());
         return std::nullopt;
     }
 
-    Model model;
+    std::vector<const aiMesh*> sourceMeshes;
+    collectMeshes(scene->mRootNode, scene, sourceMeshes);
 
-    model.m_directory = path.substr(0, path.find_last_of('/'));
-    model.processNode(scene->mRootNode, scene);
+    // Texture names come from the GL thread, so materials go first, serially.
+    std::vector<std::vector<Texture>> textures;
+    textures.reserve(sourceMeshes.size());
+
+    for (const aiMesh* mesh : sourceMeshes)
+    {
+        textures.push_back(model.loadMeshTextures(mesh, scene));
+    }
+
+    // The rest is plain CPU work per mesh. Every worker gets its own scratch
+    // arena, and results land in their mesh's slot so the order is stable.
+    ThreadPool& pool = ThreadPool::get();
+
+    std::vector<MeshData> meshes(sourceMeshes.size());
+    std::vector<MeshOptimizeStats> meshStats(sourceMeshes.size());
+    std::vector<std::unique_ptr<ScratchArena>> scratch;
+
+    for (size_t worker = 0; worker < pool.getWorkerCount(); ++worker)
+    {
+        scratch.push_back(std::make_unique<ScratchArena>());
+    }
+
+    pool.parallelFor(sourceMeshes.size(), [&](size_t idx, size_t worker)
+    {
+        MeshData& mesh = meshes[idx];
+        ScratchArena& arena = *scratch[worker];
+
+        mesh = processMesh(sourceMeshes[idx]);
+        mesh.textures = std::move(textures[idx]);
+
+        generateLods(mesh, &arena);
+        meshStats[idx] = optimizeMesh(mesh, SORT_FOR_OVERDRAW, &arena);
+
+        // Nothing allocated from the scratch arena outlives the mesh.
+        arena.release();
+    });
+
+    // Everything needed has been copied out; don't hold both at once.
+    importer.FreeScene();
+
+    MeshOptimizeStats optimizeStats;
+
+    for (const MeshOptimizeStats& stats : meshStats)
+    {
+        optimizeStats.before += stats.before;
+        optimizeStats.after += stats.after;
+    }
+
+    ScratchArena::Stats scratchStats;
+
+    for (const std::unique_ptr<ScratchArena>& arena : scratch)
+    {
+        scratchStats.allocationCount += arena->getStats().allocationCount;
+        scratchStats.allocatedBytes += arena->getStats().allocatedBytes;
+        // Workers peak at different times, so their peaks are not additive.
+        scratchStats.peakBytes = std::max(scratchStats.peakBytes, arena->getStats().peakBytes);
+    }
+
+    logInfo("Processed {} meshes on {} workers", meshes.size(), pool.getWorkerCount());
+    logDebug("Load scratch: {} allocations, {} KiB requested, {} KiB largest worker peak: {}",
+        scratchStats.allocationCount, scratchStats.allocatedBytes / 1024, scratchStats.peakBytes / 1024, path);
+
+    logDebug("Vertex cache ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}: {}",
+        optimizeStats.before.getAcmr(), optimizeStats.after.getAcmr(),
+        optimizeStats.before.getAtvr(), optimizeStats.after.getAtvr(), path);
+
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    AABB bounds;
+
+    for (const MeshData& mesh : meshes)
+    {
+        vertexCount += mesh.vertices.size();
+        indexCount += mesh.indices.size();
+        bounds.expand(AABB::fromVertices(mesh.vertices));
+    }
+
+    // Packed meshes share one arena and VAO, so they are quantized to the
+    // bounds of the whole model rather than each mesh's own box.
+    const VertexQuantization quantization = VertexQuantization::fromBounds(bounds);
+
+    MeshCache::write(path, meshes, format, quantization);
+
+    const std::shared_ptr<GeometryArena> arena = GeometryArena::create(vertexCount, indexCount, format, quantization);
+
+    model.m_meshes.reserve(meshes.size());
+
+    for (MeshData& mesh : meshes)
+    {
+        model.m_meshes.emplace_back(Mesh::create(arena, std::move(mesh), options.keepGeometry));
+    }
+
+    TextureLoader::get().submit(std::move(model.m_textureRequests));
+    model.prepareDrawLists();
 
     return std::make_optional(std::move(model));
 }
 
-void Model::draw(Shader& shader) const
+bool Model::setDrawMode(DrawMode mode)
+{
+    if (mode == DrawMode::Indirect && !IndirectDrawBuffer::isSupported())
+    {
+        logWarning("Multi-draw indirect needs GL 4.3, falling back to direct draws");
+        return false;
+    }
+
+    if (mode == DrawMode::Indirect && !m_indirectDraw)
+    {
+        m_indirectDraw = IndirectDrawBuffer::create();
+    }
+
+    m_drawMode = mode;
+
+    return true;
+}
+
+Model::DrawMode Model::getDrawMode() const
+{
+    return m_drawMode;
+}
+
+const std::vector<Mesh>& Model::getMeshes() const
 {
+    return m_meshes;
+}
+
+CullStats Model::cull(const Frustum& frustum)
+{
+    m_cullStats = frustum.cull(m_boundingSpheres, m_bounds, m_visible);
+
+    m_visibleOrder.clear();
+
+    for (const uint32_t idx : m_drawOrder)
+    {
+        if (m_visible[idx])
+        {
+            m_visibleOrder.push_back(idx);
+        }
+    }
+
+    return m_cullStats;
+}
+
+void Model::selectLods(const glm::vec3& viewPosition, float projectionScale, const glm::mat4& transform)
+{
+    const glm::vec3 localViewPosition = glm::vec3(glm::inverse(transform) * glm::vec4(viewPosition, 1.0f));
+
+    for (size_t idx = 0; idx < m_meshes.size(); ++idx)
+    {
+        const BoundingSphere& sphere = m_boundingSpheres[idx];
+        const float distance = glm::length(sphere.center - localViewPosition) - sphere.radius;
+
+        m_lods[idx] = m_meshes[idx].selectLod(distance, projectionScale);
+        m_meshes[idx].requestTextures(distance, projectionScale);
+    }
+}
+
+const CullStats& Model::getCullStats() const
+{
+    return m_cullStats;
+}
+
+void Model::draw(const Shader& shader) const
+{
+    ProfileZone zone("Model::draw");
+    GpuProfileZone gpuZone("Model::draw");
+
+    if (m_drawMode == DrawMode::Indirect)
+    {
+        m_indirectDraw->draw(shader, m_meshes, m_visibleOrder, m_lods);
+        return;
+    }
+
+    for (size_t idx = 0; idx < m_meshes.size(); ++idx)
+    {
+        if (m_visible[idx])
+        {
+            m_meshes[idx].draw(shader, m_lods[idx]);
+        }
+    }
+}
+
+void Model::submit(RenderQueue& queue, const Shader& shader, const glm::mat4& transform, float depth) const
+{
+    if (m_drawMode == DrawMode::Indirect)
+    {
+        if (!m_visibleOrder.empty())
+        {
+            queue.submit(shader, *this, m_meshes[m_visibleOrder.front()], transform, depth);
+        }
+
+        return;
+    }
+
+    for (size_t idx = 0; idx < m_meshes.size(); ++idx)
+    {
+        if (m_visible[idx])
+        {
+            queue.submit(shader, m_meshes[idx], transform, depth, m_lods[idx]);
+        }
+    }
+}
+
+void Model::prepareDrawLists()
+{
+    m_drawOrder.resize(m_meshes.size());
+
+    for (size_t idx = 0; idx < m_drawOrder.size(); ++idx)
+    {
+        m_drawOrder[idx] = static_cast<uint32_t>(idx);
+    }
+
+    auto byMaterial = [this](uint32_t lhs, uint32_t rhs) { return m_meshes[lhs].getTextureKey() < m_meshes[rhs].getTextureKey(); };
+    std::stable_sort(m_drawOrder.begin(), m_drawOrder.end(), byMaterial);
+
+    m_boundingSpheres.clear();
+    m_bounds.clear();
+
     for (const Mesh& mesh : m_meshes)
     {
-        mesh.draw(shader);
+        m_boundingSpheres.push_back(mesh.getBoundingSphere());
+        m_bounds.push_back(mesh.getBounds());
     }
+
+    m_visible.assign(m_meshes.size(), 1);
+    m_visibleOrder = m_drawOrder;
+    m_lods.assign(m_meshes.size(), 0);
+    m_cullStats = CullStats { static_cast<uint32_t>(m_meshes.size()), static_cast<uint32_t>(m_meshes.size()) };
 }
 
-void Model::processNode(const aiNode* node, const aiScene* scene)
+void Model::collectMeshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& meshes)
 {
     for (size_t idx = 0; idx < node->mNumMeshes; ++idx)
     {
-        const aiMesh* mesh = scene->mMeshes[node->mMeshes[idx]];
-        m_meshes.emplace_back(processMesh(mesh, scene));
+        meshes.push_back(scene->mMeshes[node->mMeshes[idx]]);
     }
 
     for (size_t idx = 0; idx < node->mNumChildren; ++idx)
     {
-        processNode(node->mChildren[idx], scene);
+        collectMeshes(node->mChildren[idx], scene, meshes);
     }
 }
 
-Mesh Model::processMesh(const aiMesh* mesh, const aiScene* scene)
+MeshData Model::processMesh(const aiMesh* mesh)
 {
     std::vector<Vertex> vertices;
     std::vector<unsigned int> indices;
-    std::vector<Texture> textures;
+
+    // aiProcess_Triangulate leaves only triangles (and the odd point/line).
+    vertices.reserve(mesh->mNumVertices);
+    indices.reserve(static_cast<size_t>(mesh->mNumFaces) * 3);
 
     for (size_t idx = 0; idx < mesh->mNumVertices; ++idx)
     {
@@ -90,55 +376,48 @@ Mesh Model::processMesh(const aiMesh* mesh, const aiScene* scene)
         }
     }
 
-    const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
-
-    std::vector<Texture> diffuseMaps = loadMaterialTextures(material, aiTextureType_DIFFUSE, Texture::Type::Diffuse);
-    textures.insert(textures.end(), diffuseMaps.begin(), diffuseMaps.end());
+    return MeshData { std::move(vertices), std::move(indices), {}, {} };
+}
 
-    std::vector<Texture> specularMaps = loadMaterialTextures(material, aiTextureType_SPECULAR, Texture::Type::Specular);
-    textures.insert(textures.end(), specularMaps.begin(), specularMaps.end());
+std::vector<Texture> Model::loadMeshTextures(const aiMesh* mesh, const aiScene* scene)
+{
+    const aiMaterial* material = scene->mMaterials[mesh->mMaterialIndex];
 
-    std::vector<Texture> normalMaps = loadMaterialTextures(material, aiTextureType_HEIGHT, Texture::Type::Normal);
-    textures.insert(textures.end(), normalMaps.begin(), normalMaps.end());
+    std::vector<Texture> textures;
 
-    std::vector<Texture> heightMaps = loadMaterialTextures(material, aiTextureType_AMBIENT, Texture::Type::Height);
-    textures.insert(textures.end(), heightMaps.begin(), heightMaps.end());
+    loadMaterialTextures(material, aiTextureType_DIFFUSE, Texture::Type::Diffuse, textures);
+    loadMaterialTextures(material, aiTextureType_SPECULAR, Texture::Type::Specular, textures);
+    loadMaterialTextures(material, aiTextureType_HEIGHT, Texture::Type::Normal, textures);
+    loadMaterialTextures(material, aiTextureType_AMBIENT, Texture::Type::Height, textures);
 
-    return Mesh::create(vertices, indices, textures);
+    return textures;
 }
 
-std::vector<Texture> Model::loadMaterialTextures(const aiMaterial* mat, const aiTextureType aiType, Texture::Type type)
+void Model::loadMaterialTextures(const aiMaterial* mat, const aiTextureType aiType, Texture::Type type, std::vector<Texture>& textures)
 {
-    std::vector<Texture> textures;
-
     for (size_t idx = 0; idx < mat->GetTextureCount(aiType); ++idx)
     {
         aiString str;
         mat->GetTexture(aiType, idx, &str);
 
-        auto predicate = [&str](const Texture& texture) { return std::strcmp(texture.file.data(), str.C_Str()) == 0; };
-        auto it = std::find_if(m_loadedTextures.begin(), m_loadedTextures.end(), predicate);
+        std::string_view file(str.C_Str(), str.length);
+        file = file.substr(file.find_last_of('/') + 1);
 
-        if (it != m_loadedTextures.end())
-        {
-            textures.push_back(*it);
-            continue;
-        }
-
-        std::string file = str.C_Str();
-        file = file.substr(file.find_last_of('/') + 1, file.size() - 1);
-
-        auto textureOpt = Texture::load(file, std::string(m_directory), type);
+        auto textureOpt = loadTexture(file, type);
 
         if (!textureOpt)
         {
-            log("[Error] Failed to load texture: ", str.C_Str());
+            logError("Failed to load texture: ", str.C_Str());
             continue;
         }
 
-        m_loadedTextures.push_back(*textureOpt);
         textures.push_back(*textureOpt);
     }
+}
 
-    return textures;
+std::optional<Texture> Model::loadTexture(std::string_view file, Texture::Type type)
+{
+    const TextureParams params { true, type == Texture::Type::Diffuse, true };
+
+    return Texture { TextureCache::get().acquire(m_directory, file, params, m_textureRequests), type, std::string(file) };
 }
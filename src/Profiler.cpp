@@ -0,0 +1,328 @@
+#include "Profiler.hpp"
+
+#include "Logger.hpp"
+
+#include <GL/glew.h>
+
+#include <cstdio>
+#include <format>
+#include <algorithm>
+
+
+namespace
+{
+    thread_local const char* t_threadName = nullptr;
+}
+
+
+std::atomic<bool> Profiler::s_enabled = false;
+
+Profiler& Profiler::get()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() : m_epoch(std::chrono::steady_clock::now()) {}
+
+bool Profiler::isEnabled()
+{
+    return s_enabled.load(std::memory_order_relaxed);
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    s_enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    // Rings are only allocated for threads that record, the name is
+    // attached when that happens.
+    t_threadName = name;
+
+    if (isEnabled())
+    {
+        getRing().name.store(name, std::memory_order_relaxed);
+    }
+}
+
+void Profiler::beginFrame()
+{
+    if (!isEnabled())
+    {
+        return;
+    }
+
+    drainRings();
+
+    if (!m_gpuInitialized)
+    {
+        m_gpuSupported = GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+        m_gpuInitialized = true;
+
+        if (m_gpuSupported)
+        {
+            for (GpuFrame& frame : m_gpuFrames)
+            {
+                glGenQueries(static_cast<GLsizei>(frame.queries.size()), frame.queries.data());
+            }
+        }
+    }
+
+    if (!m_gpuSupported)
+    {
+        return;
+    }
+
+    // The frame being recycled was issued GPU_FRAMES - 1 frames ago.
+    m_gpuFrame = (m_gpuFrame + 1) % GPU_FRAMES;
+    GpuFrame& frame = m_gpuFrames[m_gpuFrame];
+
+    resolveGpuFrame(frame, false);
+
+    glGetInteger64v(GL_TIMESTAMP, &frame.gpuBase);
+    frame.cpuBase = now();
+}
+
+bool Profiler::writeTrace(const std::string& path)
+{
+    drainRings();
+
+    if (m_gpuSupported)
+    {
+        for (uint32_t offset = 1; offset <= GPU_FRAMES; ++offset)
+        {
+            resolveGpuFrame(m_gpuFrames[(m_gpuFrame + offset) % GPU_FRAMES], true);
+        }
+    }
+
+    const size_t droppedZones = m_droppedZones.load(std::memory_order_relaxed);
+
+    if (droppedZones > 0 || m_droppedEvents > 0 || m_droppedGpuFrames > 0)
+    {
+        logWarning("Profiler dropped {} zones from full rings, {} events over the trace limit and {} pending GPU frames", droppedZones, m_droppedEvents, m_droppedGpuFrames);
+    }
+
+    FILE* file = std::fopen(path.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        logError("Failed to open trace file: {}", path);
+        return false;
+    }
+
+    bool result = std::fputs("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n", file) >= 0;
+    result = result && std::fputs("{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"GPU\"}}", file) >= 0;
+
+    {
+        std::lock_guard lock(m_ringMutex);
+
+        for (const std::unique_ptr<Ring>& ring : m_rings)
+        {
+            const char* name = ring->name.load(std::memory_order_relaxed);
+            const std::string threadName = name != nullptr ? std::string(name) : std::format("Thread {}", ring->thread);
+            const std::string line = std::format(",\n{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":{},\"args\":{{\"name\":\"{}\"}}}}", ring->thread, threadName);
+
+            result = result && std::fputs(line.c_str(), file) >= 0;
+        }
+    }
+
+    for (const Event& event : m_events)
+    {
+        const std::string line = std::format(",\n{{\"name\":\"{}\",\"cat\":\"{}\",\"ph\":\"X\",\"pid\":1,\"tid\":{},\"ts\":{:.3f},\"dur\":{:.3f}}}",
+            event.name, event.thread == GPU_THREAD ? "gpu" : "cpu", event.thread,
+            static_cast<double>(event.start) / 1000.0, static_cast<double>(event.end - event.start) / 1000.0);
+
+        result = result && std::fputs(line.c_str(), file) >= 0;
+    }
+
+    result = result && std::fputs("\n]}\n", file) >= 0;
+    result = (std::fclose(file) == 0) && result;
+
+    if (!result)
+    {
+        logError("Failed to write trace file: {}", path);
+        return false;
+    }
+
+    logInfo("Wrote {} profiler events to {}", m_events.size(), path);
+
+    return true;
+}
+
+void Profiler::recordCpuZone(const char* name, uint64_t start, uint64_t end)
+{
+    Ring& ring = getRing();
+
+    const size_t head = ring.head.load(std::memory_order_relaxed);
+
+    if (head - ring.tail.load(std::memory_order_acquire) == RING_CAPACITY)
+    {
+        m_droppedZones.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring.events[head % RING_CAPACITY] = Event { name, start, end, ring.thread };
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+uint32_t Profiler::beginGpuZone(const char* name)
+{
+    if (!isEnabled() || !m_gpuSupported)
+    {
+        return NO_ZONE;
+    }
+
+    GpuFrame& frame = m_gpuFrames[m_gpuFrame];
+
+    if (frame.zoneCount == GPU_ZONES)
+    {
+        return NO_ZONE;
+    }
+
+    const uint32_t zone = frame.zoneCount++;
+
+    frame.names[zone] = name;
+    frame.ended[zone] = false;
+    frame.lastQuery = 2 * zone;
+    glQueryCounter(frame.queries[2 * zone], GL_TIMESTAMP);
+
+    return m_gpuFrame * GPU_ZONES + zone;
+}
+
+void Profiler::endGpuZone(uint32_t zone)
+{
+    if (zone == NO_ZONE)
+    {
+        return;
+    }
+
+    GpuFrame& frame = m_gpuFrames[zone / GPU_ZONES];
+    const uint32_t index = zone % GPU_ZONES;
+
+    frame.ended[index] = true;
+    frame.lastQuery = 2 * index + 1;
+    glQueryCounter(frame.queries[2 * index + 1], GL_TIMESTAMP);
+}
+
+uint64_t Profiler::now() const
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_epoch).count();
+}
+
+Profiler::Ring& Profiler::getRing()
+{
+    thread_local Ring* ring = nullptr;
+
+    if (ring == nullptr)
+    {
+        std::lock_guard lock(m_ringMutex);
+
+        m_rings.push_back(std::make_unique<Ring>());
+        ring = m_rings.back().get();
+        ring->thread = static_cast<uint32_t>(m_rings.size());
+        ring->name.store(t_threadName, std::memory_order_relaxed);
+    }
+
+    return *ring;
+}
+
+void Profiler::drainRings()
+{
+    std::lock_guard lock(m_ringMutex);
+
+    for (const std::unique_ptr<Ring>& ring : m_rings)
+    {
+        const size_t tail = ring->tail.load(std::memory_order_relaxed);
+        const size_t head = ring->head.load(std::memory_order_acquire);
+
+        for (size_t idx = tail; idx != head; ++idx)
+        {
+            addEvent(ring->events[idx % RING_CAPACITY]);
+        }
+
+        ring->tail.store(head, std::memory_order_release);
+    }
+}
+
+void Profiler::resolveGpuFrame(GpuFrame& frame, bool wait)
+{
+    if (frame.zoneCount == 0)
+    {
+        return;
+    }
+
+    if (!wait)
+    {
+        GLuint available = 0;
+        glGetQueryObjectuiv(frame.queries[frame.lastQuery], GL_QUERY_RESULT_AVAILABLE, &available);
+
+        if (!available)
+        {
+            ++m_droppedGpuFrames;
+            frame.zoneCount = 0;
+            return;
+        }
+    }
+
+    auto toCpuTime = [&frame](GLuint64 timestamp)
+    {
+        const int64_t time = static_cast<int64_t>(frame.cpuBase) + (static_cast<int64_t>(timestamp) - frame.gpuBase);
+        return static_cast<uint64_t>(std::max<int64_t>(time, 0));
+    };
+
+    for (uint32_t zone = 0; zone < frame.zoneCount; ++zone)
+    {
+        if (!frame.ended[zone])
+        {
+            continue;
+        }
+
+        GLuint64 begin = 0;
+        GLuint64 end = 0;
+
+        glGetQueryObjectui64v(frame.queries[2 * zone], GL_QUERY_RESULT, &begin);
+        glGetQueryObjectui64v(frame.queries[2 * zone + 1], GL_QUERY_RESULT, &end);
+
+        addEvent(Event { frame.names[zone], toCpuTime(begin), toCpuTime(std::max(begin, end)), GPU_THREAD });
+    }
+
+    frame.zoneCount = 0;
+}
+
+void Profiler::addEvent(const Event& event)
+{
+    if (m_events.size() == MAX_EVENTS)
+    {
+        ++m_droppedEvents;
+        return;
+    }
+
+    m_events.push_back(event);
+}
+
+ProfileZone::ProfileZone(const char* name) : m_name(name)
+{
+    if (Profiler::isEnabled())
+    {
+        m_start = Profiler::get().now();
+        m_active = true;
+    }
+}
+
+ProfileZone::~ProfileZone()
+{
+    if (m_active)
+    {
+        Profiler& profiler = Profiler::get();
+        profiler.recordCpuZone(m_name, m_start, profiler.now());
+    }
+}
+
+GpuProfileZone::GpuProfileZone(const char* name) : m_zone(Profiler::get().beginGpuZone(name)) {}
+
+GpuProfileZone::~GpuProfileZone()
+{
+    Profiler::get().endGpuZone(m_zone);
+}
\ No newline at end of file
@@ -0,0 +1,233 @@
+#include "ProgramCache.hpp"
+
+#include "Hash.hpp"
+#include "Logger.hpp"
+
+#include <GL/glew.h>
+
+#include <chrono>
+#include <cstdio>
+#include <format>
+#include <vector>
+#include <cstring>
+#include <filesystem>
+
+
+namespace
+{
+    constexpr char CACHE_MAGIC[8] = { 'P', 'R', 'O', 'G', 'B', 'I', 'N', '\0' };
+    constexpr uint32_t CACHE_VERSION = 1;
+
+    // Guards against truncated or foreign files before the size is trusted.
+    constexpr uint64_t MAX_BINARY_SIZE = 64 * 1024 * 1024;
+
+    struct CacheHeader
+    {
+        char magic[8];
+        uint32_t version;
+        uint32_t binaryFormat;
+        uint64_t key;
+        uint64_t binarySize;
+        uint64_t binaryHash;
+    };
+
+    std::string_view getString(GLenum name)
+    {
+        const char* value = reinterpret_cast<const char*>(glGetString(name));
+        return value != nullptr ? std::string_view(value) : std::string_view();
+    }
+
+    uint64_t hashField(std::string_view text, uint64_t hash)
+    {
+        // The terminator keeps "ab" + "c" and "a" + "bc" apart.
+        hash = fnv1a(text, hash);
+        return fnv1a("\0", 1, hash);
+    }
+
+    double getMilliseconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+
+ProgramCache& ProgramCache::get()
+{
+    static ProgramCache cache;
+    return cache;
+}
+
+bool ProgramCache::isSupported()
+{
+    if (!m_initialized)
+    {
+        m_initialized = true;
+
+        GLint formatCount = 0;
+
+        if (GLEW_VERSION_4_1 || GLEW_ARB_get_program_binary)
+        {
+            glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        }
+
+        m_supported = formatCount > 0;
+
+        m_driverHash = hashField(getString(GL_VENDOR), FNV_OFFSET_BASIS);
+        m_driverHash = hashField(getString(GL_RENDERER), m_driverHash);
+        m_driverHash = hashField(getString(GL_VERSION), m_driverHash);
+
+        if (!m_supported)
+        {
+            logInfo("Program binaries unavailable, shaders are compiled on every start");
+        }
+    }
+
+    return m_supported;
+}
+
+uint64_t ProgramCache::makeKey(std::string_view vertexSource, std::string_view fragmentSource)
+{
+    isSupported();
+
+    uint64_t hash = hashField(vertexSource, m_driverHash);
+    return hashField(fragmentSource, hash);
+}
+
+std::optional<uint32_t> ProgramCache::load(uint64_t key)
+{
+    if (!isSupported())
+    {
+        return std::nullopt;
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    const std::string path = getPath(key);
+
+    FILE* file = std::fopen(path.c_str(), "rb");
+
+    if (file == nullptr)
+    {
+        ++m_stats.misses;
+        return std::nullopt;
+    }
+
+    CacheHeader header;
+    std::vector<uint8_t> binary;
+
+    bool valid = std::fread(&header, sizeof(header), 1, file) == 1
+        && std::memcmp(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC)) == 0
+        && header.version == CACHE_VERSION
+        && header.key == key
+        && header.binarySize > 0 && header.binarySize <= MAX_BINARY_SIZE;
+
+    if (valid)
+    {
+        binary.resize(header.binarySize);
+        valid = std::fread(binary.data(), binary.size(), 1, file) == 1 && fnv1a(binary.data(), binary.size()) == header.binaryHash;
+    }
+
+    std::fclose(file);
+
+    if (!valid)
+    {
+        logWarning("Program cache entry is corrupt: {}", path);
+        ++m_stats.misses;
+        return std::nullopt;
+    }
+
+    const uint32_t program = glCreateProgram();
+    glProgramBinary(program, header.binaryFormat, binary.data(), static_cast<GLsizei>(binary.size()));
+
+    GLint linked = 0;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+
+    if (!linked)
+    {
+        // Drivers may reject binaries after an update that kept the version
+        // string, the caller compiles from source and overwrites the entry.
+        logInfo("Program binary rejected by the driver: {}", path);
+        glDeleteProgram(program);
+        ++m_stats.rejected;
+        return std::nullopt;
+    }
+
+    ++m_stats.hits;
+    m_stats.loadTime += getMilliseconds(start);
+
+    return program;
+}
+
+bool ProgramCache::store(uint64_t key, uint32_t program)
+{
+    if (!isSupported())
+    {
+        return false;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+
+    if (length <= 0)
+    {
+        return false;
+    }
+
+    std::vector<uint8_t> binary(length);
+    GLenum binaryFormat = 0;
+    glGetProgramBinary(program, length, &length, &binaryFormat, binary.data());
+    binary.resize(length);
+
+    CacheHeader header {};
+    std::memcpy(header.magic, CACHE_MAGIC, sizeof(CACHE_MAGIC));
+    header.version = CACHE_VERSION;
+    header.binaryFormat = binaryFormat;
+    header.key = key;
+    header.binarySize = binary.size();
+    header.binaryHash = fnv1a(binary.data(), binary.size());
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(DIRECTORY), error);
+
+    const std::string path = getPath(key);
+    const std::string temporaryPath = path + ".tmp";
+
+    FILE* file = std::fopen(temporaryPath.c_str(), "wb");
+
+    if (file == nullptr)
+    {
+        logWarning("Failed to create program cache entry: {}", path);
+        return false;
+    }
+
+    bool result = std::fwrite(&header, sizeof(header), 1, file) == 1
+        && std::fwrite(binary.data(), binary.size(), 1, file) == 1;
+
+    result = (std::fclose(file) == 0) && result;
+
+    if (!result || std::rename(temporaryPath.c_str(), path.c_str()) != 0)
+    {
+        logWarning("Failed to write program cache entry: {}", path);
+        std::remove(temporaryPath.c_str());
+        return false;
+    }
+
+    ++m_stats.stored;
+
+    return true;
+}
+
+void ProgramCache::addCompile(double milliseconds)
+{
+    ++m_stats.compiled;
+    m_stats.compileTime += milliseconds;
+}
+
+ProgramCache::Stats ProgramCache::getStats() const
+{
+    return m_stats;
+}
+
+std::string ProgramCache::getPath(uint64_t key) const
+{
+    return std::format("{}/{:016x}.progbin", DIRECTORY, key);
+}
\ No newline at end of file
@@ -0,0 +1,167 @@
+#include "RenderQueue.hpp"
+
+#include "Model.hpp"
+#include "Profiler.hpp"
+
+#include <array>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint32_t PROGRAM_BITS = 8;
+    constexpr uint32_t TEXTURE_BITS = 20;
+    constexpr uint32_t VERTEX_ARRAY_BITS = 16;
+    constexpr uint32_t DEPTH_BITS = 20;
+
+    static_assert(PROGRAM_BITS + TEXTURE_BITS + VERTEX_ARRAY_BITS + DEPTH_BITS == 64);
+
+    constexpr uint32_t DEPTH_SHIFT = 0;
+    constexpr uint32_t VERTEX_ARRAY_SHIFT = DEPTH_SHIFT + DEPTH_BITS;
+    constexpr uint32_t TEXTURE_SHIFT = VERTEX_ARRAY_SHIFT + VERTEX_ARRAY_BITS;
+    constexpr uint32_t PROGRAM_SHIFT = TEXTURE_SHIFT + TEXTURE_BITS;
+
+    constexpr uint64_t mask(uint32_t bits)
+    {
+        return (uint64_t(1) << bits) - 1;
+    }
+}
+
+
+RenderQueue::RenderQueue(float maxDepth) : m_maxDepth(maxDepth) {}
+
+void RenderQueue::submit(const Shader& shader, const Mesh& mesh, const glm::mat4& transform, float depth, uint32_t lod)
+{
+    m_entries.push_back({ createKey(shader, mesh, depth), static_cast<uint32_t>(m_packets.size()) });
+    m_packets.push_back({ &shader, &mesh, nullptr, transform, lod });
+}
+
+void RenderQueue::submit(const Shader& shader, const Model& model, const Mesh& keyMesh, const glm::mat4& transform, float depth)
+{
+    m_entries.push_back({ createKey(shader, keyMesh, depth), static_cast<uint32_t>(m_packets.size()) });
+    m_packets.push_back({ &shader, &keyMesh, &model, transform, 0 });
+}
+
+void RenderQueue::flush(UniformRing& uniforms)
+{
+    ProfileZone zone("RenderQueue::flush");
+    GpuProfileZone gpuZone("RenderQueue::flush");
+
+    sort();
+
+    const Shader* currentShader = nullptr;
+    uint64_t currentTextures = 0;
+    const GeometryArena* currentArena = nullptr;
+    bool materialBound = false;
+    const glm::mat4* currentTransform = nullptr;
+
+    for (const SortEntry& entry : m_entries)
+    {
+        const Packet& packet = m_packets[entry.packet];
+        const bool programChanged = packet.shader != currentShader;
+
+        if (programChanged)
+        {
+            packet.shader->use();
+            currentShader = packet.shader;
+        }
+
+        // The Object block is shared by all programs, so it only changes with
+        // the transform; the normal matrix is computed here once per block
+        // instead of per vertex.
+        if (currentTransform == nullptr || *currentTransform != packet.transform)
+        {
+            const ObjectBlock object { packet.transform, glm::transpose(glm::inverse(packet.transform)) };
+
+            uniforms.bind(UniformBinding::Object, uniforms.push(object));
+            currentTransform = &packet.transform;
+        }
+
+        if (packet.model != nullptr)
+        {
+            packet.model->draw(*packet.shader);
+            materialBound = false;
+            continue;
+        }
+
+        // Packed arenas carry their own dequantization, so a new arena needs
+        // the material rebound as well.
+        if (programChanged || !materialBound || packet.mesh->getTextureKey() != currentTextures || &packet.mesh->getArena() != currentArena)
+        {
+            packet.mesh->bindMaterial(*packet.shader);
+            currentTextures = packet.mesh->getTextureKey();
+            currentArena = &packet.mesh->getArena();
+            materialBound = true;
+        }
+
+        packet.mesh->drawElements(packet.lod);
+    }
+
+    m_packets.clear();
+    m_entries.clear();
+}
+
+size_t RenderQueue::getPacketCount() const
+{
+    return m_packets.size();
+}
+
+uint64_t RenderQueue::createKey(const Shader& shader, const Mesh& mesh, float depth) const
+{
+    const float normalizedDepth = std::clamp(depth / m_maxDepth, 0.0f, 1.0f);
+    const uint64_t quantizedDepth = static_cast<uint64_t>(normalizedDepth * static_cast<float>(mask(DEPTH_BITS)));
+
+    // Fold the wide identifiers so that equal state still maps to equal bits.
+    const uint64_t textureKey = mesh.getTextureKey() ^ (mesh.getTextureKey() >> TEXTURE_BITS) ^ (mesh.getTextureKey() >> (2 * TEXTURE_BITS));
+
+    return ((shader.getId() & mask(PROGRAM_BITS)) << PROGRAM_SHIFT)
+        | ((textureKey & mask(TEXTURE_BITS)) << TEXTURE_SHIFT)
+        | ((mesh.getVertexArray() & mask(VERTEX_ARRAY_BITS)) << VERTEX_ARRAY_SHIFT)
+        | ((quantizedDepth & mask(DEPTH_BITS)) << DEPTH_SHIFT);
+}
+
+void RenderQueue::sort()
+{
+    // LSD radix sort over the key bytes. Bytes that are equal across all keys
+    // are skipped, which is the common case for the program and VAO bytes.
+    constexpr size_t RADIX = 256;
+    constexpr size_t PASSES = sizeof(uint64_t);
+
+    std::array<std::array<uint32_t, RADIX>, PASSES> histograms {};
+
+    for (const SortEntry& entry : m_entries)
+    {
+        for (size_t pass = 0; pass < PASSES; ++pass)
+        {
+            ++histograms[pass][(entry.key >> (pass * 8)) & 0xFF];
+        }
+    }
+
+    m_scratch.resize(m_entries.size());
+
+    for (size_t pass = 0; pass < PASSES; ++pass)
+    {
+        std::array<uint32_t, RADIX>& histogram = histograms[pass];
+
+        if (std::find(histogram.begin(), histogram.end(), m_entries.size()) != histogram.end())
+        {
+            continue;
+        }
+
+        uint32_t offset = 0;
+
+        for (uint32_t& count : histogram)
+        {
+            const uint32_t bucketSize = count;
+            count = offset;
+            offset += bucketSize;
+        }
+
+        for (const SortEntry& entry : m_entries)
+        {
+            m_scratch[histogram[(entry.key >> (pass * 8)) & 0xFF]++] = entry;
+        }
+
+        std::swap(m_entries, m_scratch);
+    }
+}
\ No newline at end of file
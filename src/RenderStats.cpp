@@ -0,0 +1,21 @@
+#include "RenderStats.hpp"
+
+
+RenderStats::Counters RenderStats::s_counters;
+
+void RenderStats::countDraw(uint64_t commands, uint64_t triangles)
+{
+    ++s_counters.drawCalls;
+    s_counters.drawCommands += commands;
+    s_counters.triangles += triangles;
+}
+
+const RenderStats::Counters& RenderStats::get()
+{
+    return s_counters;
+}
+
+void RenderStats::reset()
+{
+    s_counters = Counters {};
+}
\ No newline at end of file
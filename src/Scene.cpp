@@ -0,0 +1,152 @@
+#include "Scene.hpp"
+
+
+uint32_t Scene::addInstance(Model& model, const Shader& shader, const glm::mat4& transform)
+{
+    const uint32_t instanceIdx = static_cast<uint32_t>(m_instances.size());
+
+    m_instances.push_back({ &model, &shader, transform, glm::inverse(transform), static_cast<uint32_t>(m_items.size()) });
+
+    for (uint32_t meshIdx = 0; meshIdx < model.getMeshes().size(); ++meshIdx)
+    {
+        m_items.push_back({ instanceIdx, meshIdx });
+        m_itemBounds.emplace_back();
+    }
+
+    updateBounds(m_instances.back());
+    m_needsBuild = true;
+
+    return instanceIdx;
+}
+
+void Scene::setTransform(uint32_t instance, const glm::mat4& transform)
+{
+    Instance& target = m_instances[instance];
+
+    target.transform = transform;
+    target.inverseTransform = glm::inverse(transform);
+
+    updateBounds(target);
+    m_needsRefit = true;
+}
+
+const std::vector<uint32_t>& Scene::cull(const Frustum& frustum)
+{
+    update();
+
+    m_visibleItems.clear();
+    m_bvh.queryFrustum(frustum, m_visibleItems);
+
+    // Leaves hold a few items each; drop the ones whose own box is outside.
+    std::erase_if(m_visibleItems, [this, &frustum](uint32_t item) { return !frustum.intersects(m_itemBounds[item]); });
+
+    m_cullStats = CullStats { static_cast<uint32_t>(m_items.size()), static_cast<uint32_t>(m_visibleItems.size()) };
+
+    return m_visibleItems;
+}
+
+void Scene::submit(RenderQueue& queue, const glm::mat4& viewProjection, const glm::vec3& viewPosition, float projectionScale)
+{
+    for (const uint32_t itemIdx : cull(Frustum::fromMatrix(viewProjection)))
+    {
+        const Item& item = m_items[itemIdx];
+        const Instance& instance = m_instances[item.instance];
+
+        if (instance.model->getDrawMode() == Model::DrawMode::Indirect)
+        {
+            continue;
+        }
+
+        const Mesh& mesh = instance.model->getMeshes()[item.mesh];
+
+        const float depth = glm::length(m_itemBounds[itemIdx].getCenter() - viewPosition);
+
+        // LOD errors are in object space, so measure the distance there too.
+        const glm::vec3 localViewPosition = glm::vec3(instance.inverseTransform * glm::vec4(viewPosition, 1.0f));
+        const BoundingSphere& sphere = mesh.getBoundingSphere();
+        const float distance = glm::length(sphere.center - localViewPosition) - sphere.radius;
+        const uint32_t lod = mesh.selectLod(distance, projectionScale);
+
+        mesh.requestTextures(distance, projectionScale);
+
+        queue.submit(*instance.shader, mesh, instance.transform, depth, lod);
+    }
+
+    for (const Instance& instance : m_instances)
+    {
+        if (instance.model->getDrawMode() != Model::DrawMode::Indirect)
+        {
+            continue;
+        }
+
+        // Model bounds are in object space, so cull against the instance's own clip matrix.
+        instance.model->cull(Frustum::fromMatrix(viewProjection * instance.transform));
+        instance.model->selectLods(viewPosition, projectionScale, instance.transform);
+        instance.model->submit(queue, *instance.shader, instance.transform, glm::length(viewPosition - glm::vec3(instance.transform[3])));
+    }
+}
+
+std::optional<Scene::PickResult> Scene::pick(const Ray& ray, float maxDistance)
+{
+    update();
+
+    uint32_t hitTriangle = 0;
+
+    auto intersect = [this, &hitTriangle](uint32_t itemIdx, const Ray& worldRay, float distance) -> std::optional<float>
+    {
+        const Item& item = m_items[itemIdx];
+        const Instance& instance = m_instances[item.instance];
+
+        const Ray localRay = worldRay.transformed(instance.inverseTransform);
+        const std::optional<MeshHit> hit = instance.model->getMeshes()[item.mesh].intersect(localRay, distance);
+
+        if (!hit)
+        {
+            return std::nullopt;
+        }
+
+        hitTriangle = hit->triangle;
+        return hit->distance;
+    };
+
+    const std::optional<Bvh::RayHit> hit = m_bvh.queryRay(ray, maxDistance, intersect);
+
+    if (!hit)
+    {
+        return std::nullopt;
+    }
+
+    const Item& item = m_items[hit->item];
+
+    return PickResult { item.instance, item.mesh, hitTriangle, hit->distance, ray.origin + ray.direction * hit->distance };
+}
+
+const CullStats& Scene::getCullStats() const
+{
+    return m_cullStats;
+}
+
+void Scene::update()
+{
+    if (m_needsBuild)
+    {
+        m_bvh = Bvh::build(m_itemBounds);
+    }
+    else if (m_needsRefit)
+    {
+        m_bvh.refit(m_itemBounds);
+    }
+
+    m_needsBuild = false;
+    m_needsRefit = false;
+}
+
+void Scene::updateBounds(const Instance& instance)
+{
+    const std::vector<Mesh>& meshes = instance.model->getMeshes();
+
+    for (uint32_t meshIdx = 0; meshIdx < meshes.size(); ++meshIdx)
+    {
+        m_itemBounds[instance.firstItem + meshIdx] = meshes[meshIdx].getBounds().transformed(instance.transform);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "ScratchArena.hpp"
+
+#include <algorithm>
+
+
+ScratchArena::ScratchArena(size_t initialSize)
+    : m_buffer(initialSize, &m_upstream)
+{
+}
+
+void ScratchArena::release()
+{
+    m_buffer.release();
+}
+
+const ScratchArena::Stats& ScratchArena::getStats() const
+{
+    m_stats.peakBytes = m_upstream.peakBytes;
+
+    return m_stats;
+}
+
+void* ScratchArena::do_allocate(size_t bytes, size_t alignment)
+{
+    ++m_stats.allocationCount;
+    m_stats.allocatedBytes += bytes;
+
+    return m_buffer.allocate(bytes, alignment);
+}
+
+void ScratchArena::do_deallocate(void*, size_t, size_t)
+{
+}
+
+bool ScratchArena::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
+
+void* ScratchArena::Upstream::do_allocate(size_t bytes, size_t alignment)
+{
+    reservedBytes += bytes;
+    peakBytes = std::max(peakBytes, reservedBytes);
+
+    return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+}
+
+void ScratchArena::Upstream::do_deallocate(void* pointer, size_t bytes, size_t alignment)
+{
+    reservedBytes -= bytes;
+
+    std::pmr::new_delete_resource()->deallocate(pointer, bytes, alignment);
+}
+
+bool ScratchArena::Upstream::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+    return this == &other;
+}
\ No newline at end of file
@@ -1,129 +1,173 @@
 #include "Shader.hpp"
 
 #include "Logger.hpp"
+#include "GLState.hpp"
+#include "Profiler.hpp"
+#include "ProgramCache.hpp"
+#include "UniformRing.hpp"
 
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
 #include <cstdio>
+#include <chrono>
 #include <cstdlib>
 
 
-std::optional<Shader> Shader::create(std::string_view vertexPath, std::string_view fragmentPath)
+namespace
 {
-    FILE* vertexFile = std::fopen(vertexPath.data(), "rb");
-
-    if (vertexFile == nullptr)
+    std::optional<std::string> readSource(std::string_view path, std::string_view stage)
     {
-        log("[Error] Failed to open vertex shader file: {}", vertexPath);
-        return std::nullopt;
-    }
+        FILE* file = std::fopen(path.data(), "rb");
 
-    std::fseek(vertexFile, 0, SEEK_END);
-    const size_t vertexSourceSize = std::ftell(vertexFile);
-    std::fseek(vertexFile, 0, SEEK_SET);
+        if (file == nullptr)
+        {
+            logError("Failed to open {} shader file: {}", stage, path);
+            return std::nullopt;
+        }
 
-    std::string vertexShadersource(vertexSourceSize, '\0');
-    size_t size = std::fread(vertexShadersource.data(), vertexSourceSize, 1, vertexFile);
+        std::fseek(file, 0, SEEK_END);
+        const size_t sourceSize = std::ftell(file);
+        std::fseek(file, 0, SEEK_SET);
 
-    if (size != 1)
-    {
-        log("[Error] Failed to read vertex shader file: {}", vertexPath);
-        return std::nullopt;
-    }
+        std::string source(sourceSize, '\0');
+        const size_t size = std::fread(source.data(), sourceSize, 1, file);
 
-    std::fclose(vertexFile);
+        std::fclose(file);
 
-    FILE* fragmentFile = std::fopen(fragmentPath.data(), "rb");
+        if (size != 1)
+        {
+            logError("Failed to read {} shader file: {}", stage, path);
+            return std::nullopt;
+        }
 
-    if (fragmentFile == nullptr)
-    {
-        log("[Error] Failed to open fragment shader file: {}", fragmentPath);
-        return std::nullopt;
+        return source;
     }
 
-    std::fseek(fragmentFile, 0, SEEK_END);
-    const size_t fragmentSourceSize = std::ftell(fragmentFile);
-    std::fseek(fragmentFile, 0, SEEK_SET);
-
-    std::string fragmentShadersource(fragmentSourceSize, '\0');
-    size = std::fread(fragmentShadersource.data(), fragmentSourceSize, 1, fragmentFile);
-
-    if (size != 1)
+    std::optional<uint32_t> compileProgram(const std::string& vertexShaderSource, const std::string& fragmentShaderSource, bool retrievable)
     {
-        log("[Error] Failed to read fragment shader file: {}", fragmentPath);
-        return std::nullopt;
+        uint32_t vertexShader;
+        uint32_t fragmentShader;
+        int32_t result;
+        char infoLog[512];
+
+        vertexShader = glCreateShader(GL_VERTEX_SHADER);
+        const char* vertexSource = vertexShaderSource.c_str();
+        glShaderSource(vertexShader, 1, &vertexSource, nullptr);
+        glCompileShader(vertexShader);
+        glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &result);
+
+        if (!result)
+        {
+            glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
+            logError("Vertex shader compilation failed:\n {}", infoLog);
+            return std::nullopt;
+        }
+
+        fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
+        const char* fragmentSource = fragmentShaderSource.c_str();
+        glShaderSource(fragmentShader, 1, &fragmentSource, nullptr);
+        glCompileShader(fragmentShader);
+        glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &result);
+
+        if (!result)
+        {
+            glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
+            logError("Fragment shader compilation failed:\n {}", infoLog);
+            return std::nullopt;
+        }
+
+        uint32_t id = glCreateProgram();
+
+        if (retrievable)
+        {
+            glProgramParameteri(id, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+        }
+
+        glAttachShader(id, vertexShader);
+        glAttachShader(id, fragmentShader);
+        glLinkProgram(id);
+        glGetProgramiv(id, GL_LINK_STATUS, &result);
+
+        if (!result)
+        {
+            glGetProgramInfoLog(id, 512, nullptr, infoLog);
+            logError("Shader program linking failed:\n {}", infoLog);
+            return std::nullopt;
+        }
+
+        glDeleteShader(vertexShader);
+        glDeleteShader(fragmentShader);
+
+        return id;
     }
-
-    std::fclose(fragmentFile);
+}
 
 
-    uint32_t vertexShader;
-    uint32_t fragmentShader;
-    int32_t result;
-    char infoLog[512];
+std::optional<Shader> Shader::create(std::string_view vertexPath, std::string_view fragmentPath)
+{
+    ProfileZone zone("Shader::create");
 
-    vertexShader = glCreateShader(GL_VERTEX_SHADER);
-    const char* vertexSource = vertexShadersource.c_str();
-    glShaderSource(vertexShader, 1, &vertexSource, nullptr);
-    glCompileShader(vertexShader);
-    glGetShaderiv(vertexShader, GL_COMPILE_STATUS, &result);
+    const std::optional<std::string> vertexSource = readSource(vertexPath, "vertex");
+    const std::optional<std::string> fragmentSource = readSource(fragmentPath, "fragment");
 
-    if (!result)
+    if (!vertexSource || !fragmentSource)
     {
-        glGetShaderInfoLog(vertexShader, 512, nullptr, infoLog);
-        log("[Error] Vertex shader compilation failed:\n {}", infoLog);
         return std::nullopt;
     }
 
-    fragmentShader = glCreateShader(GL_FRAGMENT_SHADER);
-    const char* fragmentSource = fragmentShadersource.c_str();
-    glShaderSource(fragmentShader, 1, &fragmentSource, nullptr);
-    glCompileShader(fragmentShader);
-    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &result);
+    ProgramCache& programCache = ProgramCache::get();
+    const uint64_t cacheKey = programCache.makeKey(*vertexSource, *fragmentSource);
+
+    std::optional<uint32_t> id = programCache.load(cacheKey);
 
-    if (!result)
+    if (!id)
     {
-        glGetShaderInfoLog(fragmentShader, 512, nullptr, infoLog);
-        log("[Error] Fragment shader compilation failed:\n {}", infoLog);
-        return std::nullopt;
-    }
+        const auto start = std::chrono::steady_clock::now();
 
-    uint32_t id = glCreateProgram();
+        id = compileProgram(*vertexSource, *fragmentSource, programCache.isSupported());
 
-    glAttachShader(id, vertexShader);
-    glAttachShader(id, fragmentShader);
-    glLinkProgram(id);
-    glGetProgramiv(id, GL_LINK_STATUS, &result);
+        if (!id)
+        {
+            return std::nullopt;
+        }
 
-    if (!result)
-    {
-        glGetProgramInfoLog(id, 512, nullptr, infoLog);
-        log("[Error] Shader program linking failed:\n {}", infoLog);
-        return std::nullopt;
+        programCache.addCompile(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+        programCache.store(cacheKey, *id);
     }
 
-    glDeleteShader(vertexShader);
-    glDeleteShader(fragmentShader);
+    Shader shader { *id };
+    shader.introspectUniforms();
+    shader.bindUniformBlocks();
+
+    shader.m_positionOffset = shader.findUniform("positionOffset");
+    shader.m_positionScale = shader.findUniform("positionScale");
 
-    return Shader { id };
+    return shader;
 }
 
 Shader::Shader(uint32_t id) : m_id(id) {}
 
 Shader::~Shader()
 {
+    GLState::forgetProgram(m_id);
     glDeleteProgram(m_id);
 }
 
 Shader::Shader(Shader&& other) noexcept
 {
     std::swap(m_id, other.m_id);
+    std::swap(m_uniforms, other.m_uniforms);
+    std::swap(m_positionOffset, other.m_positionOffset);
+    std::swap(m_positionScale, other.m_positionScale);
 }
 
 Shader& Shader::operator=(Shader&& other) noexcept
 {
     std::swap(m_id, other.m_id);
+    std::swap(m_uniforms, other.m_uniforms);
+    std::swap(m_positionOffset, other.m_positionOffset);
+    std::swap(m_positionScale, other.m_positionScale);
     return *this;
 }
 
@@ -134,46 +178,146 @@ uint32_t Shader::getId() const
 
 void Shader::use() const
 {
-    glUseProgram(m_id);
+    GLState::useProgram(m_id);
+}
+
+UniformHandle Shader::getUniform(std::string_view name) const
+{
+    const UniformHandle handle = findUniform(name);
+
+    if (!handle.isValid())
+    {
+        logLimited<LogLevel::Warning>("Uniform not found: {}", name);
+    }
+
+    return handle;
+}
+
+UniformHandle Shader::getPositionOffsetUniform() const
+{
+    return m_positionOffset;
+}
+
+UniformHandle Shader::getPositionScaleUniform() const
+{
+    return m_positionScale;
+}
+
+UniformHandle Shader::findUniform(std::string_view name) const
+{
+    auto it = m_uniforms.find(name);
+
+    if (it == m_uniforms.end())
+    {
+        return UniformHandle {};
+    }
+
+    return UniformHandle { it->second };
 }
 
 void Shader::setBool(std::string_view name, bool value) const
 {
-    glUniform1i(glGetUniformLocation(m_id, name.data()), static_cast<int>(value));
+    setBool(getUniform(name), value);
 }
 
 void Shader::setInt(std::string_view name, int value) const
 {
-    glUniform1i(glGetUniformLocation(m_id, name.data()), value);
+    setInt(getUniform(name), value);
 }
 
 void Shader::setFloat(std::string_view name, float value) const
 {
-    glUniform1f(glGetUniformLocation(m_id, name.data()), value);
+    setFloat(getUniform(name), value);
 }
 
 void Shader::setMat4(std::string_view name, const glm::mat4& value) const
 {
-    int32_t location = glGetUniformLocation(m_id, name.data());
+    setMat4(getUniform(name), value);
+}
 
-    if (location == -1)
-    {
-        log("[Warning] Uniform not found: {}", name);
-        return;
-    }
+void Shader::setVec3(std::string_view name, const glm::vec3& value) const
+{
+    setVec3(getUniform(name), value);
+}
 
-    glUniformMatrix4fv(location, 1, GL_FALSE, glm::value_ptr(value));
+void Shader::setBool(UniformHandle handle, bool value) const
+{
+    glUniform1i(handle.location, static_cast<int>(value));
 }
 
-void Shader::setVec3(std::string_view name, const glm::vec3& value) const
+void Shader::setInt(UniformHandle handle, int value) const
+{
+    glUniform1i(handle.location, value);
+}
+
+void Shader::setFloat(UniformHandle handle, float value) const
+{
+    glUniform1f(handle.location, value);
+}
+
+void Shader::setMat4(UniformHandle handle, const glm::mat4& value) const
+{
+    glUniformMatrix4fv(handle.location, 1, GL_FALSE, glm::value_ptr(value));
+}
+
+void Shader::setVec3(UniformHandle handle, const glm::vec3& value) const
+{
+    glUniform3fv(handle.location, 1, glm::value_ptr(value));
+}
+
+void Shader::introspectUniforms()
 {
-    int32_t location = glGetUniformLocation(m_id, name.data());;
+    int32_t count = 0;
+    int32_t maxLength = 0;
 
-    if (location == -1)
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORMS, &count);
+    glGetProgramiv(m_id, GL_ACTIVE_UNIFORM_MAX_LENGTH, &maxLength);
+
+    std::string buffer(maxLength, '\0');
+
+    for (int32_t idx = 0; idx < count; ++idx)
     {
-        log("[Warning] Uniform not found: {}", name);
-        return;
+        int32_t length = 0;
+        int32_t size = 0;
+        uint32_t type = 0;
+
+        glGetActiveUniform(m_id, idx, maxLength, &length, &size, &type, buffer.data());
+
+        std::string name(buffer.data(), length);
+        const int32_t location = glGetUniformLocation(m_id, name.c_str());
+
+        if (location == -1)
+        {
+            continue;
+        }
+
+        if (name.ends_with("[0]"))
+        {
+            const std::string base = name.substr(0, name.size() - 3);
+
+            for (int32_t element = 1; element < size; ++element)
+            {
+                const std::string elementName = base + '[' + std::to_string(element) + ']';
+                m_uniforms.emplace(elementName, glGetUniformLocation(m_id, elementName.c_str()));
+            }
+
+            m_uniforms.emplace(base, location);
+        }
+
+        m_uniforms.emplace(std::move(name), location);
     }
+}
 
-    glUniform3fv(location, 1, glm::value_ptr(value));
+void Shader::bindUniformBlocks()
+{
+    for (size_t binding = 0; binding < UNIFORM_BLOCK_NAMES.size(); ++binding)
+    {
+        const std::string name(UNIFORM_BLOCK_NAMES[binding]);
+        const uint32_t index = glGetUniformBlockIndex(m_id, name.c_str());
+
+        if (index != GL_INVALID_INDEX)
+        {
+            glUniformBlockBinding(m_id, index, static_cast<uint32_t>(binding));
+        }
+    }
 }
\ No newline at end of file
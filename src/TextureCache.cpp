@@ -0,0 +1,127 @@
+#include "TextureCache.hpp"
+
+#include "Hash.hpp"
+
+#include <filesystem>
+#include <system_error>
+
+
+namespace
+{
+    uint32_t getFlags(const TextureParams& params)
+    {
+        return (params.flipVertically ? 1u : 0u) | (params.srgb ? 2u : 0u) | (params.streamed ? 4u : 0u);
+    }
+
+    std::string joinPath(std::string_view directory, std::string_view file)
+    {
+        return (std::filesystem::path(directory) / file).string();
+    }
+}
+
+
+TextureCache& TextureCache::get()
+{
+    static TextureCache cache;
+    return cache;
+}
+
+std::shared_ptr<TextureResource> TextureCache::acquire(std::string_view directory, std::string_view file, const TextureParams& params, std::vector<TextureLoader::Request>& requests)
+{
+    const std::string& key = getKey({ directory, file, getFlags(params) });
+
+    auto it = m_entries.find(key);
+
+    if (it != m_entries.end())
+    {
+        if (std::shared_ptr<TextureResource> texture = it->second.lock())
+        {
+            ++m_hits;
+            return texture;
+        }
+    }
+
+    ++m_misses;
+
+    // The deleter drops the entry together with the texture, so the map only
+    // ever holds live textures.
+    auto deleter = [this, key](TextureResource* resource)
+    {
+        auto entry = m_entries.find(key);
+
+        if (entry != m_entries.end() && entry->second.expired())
+        {
+            m_entries.erase(entry);
+        }
+
+        delete resource;
+    };
+
+    std::shared_ptr<TextureResource> texture(new TextureResource(Texture::createPlaceholder()), deleter);
+
+    m_entries.insert_or_assign(key, texture);
+    requests.push_back({ texture, joinPath(directory, file), params });
+
+    return texture;
+}
+
+TextureCache::Stats TextureCache::getStats() const
+{
+    Stats stats;
+    stats.hits = m_hits;
+    stats.misses = m_misses;
+
+    for (const auto& [key, entry] : m_entries)
+    {
+        if (const std::shared_ptr<TextureResource> texture = entry.lock())
+        {
+            ++stats.residentCount;
+            stats.residentBytes += texture->bytes;
+        }
+    }
+
+    return stats;
+}
+
+size_t TextureCache::SpellingHash::operator()(const Spelling& spelling) const
+{
+    // The flags sit between the strings, so "a" + "bc" and "ab" + "c" differ.
+    uint64_t hash = fnv1a(spelling.directory);
+    hash = fnv1a(&spelling.flags, sizeof(spelling.flags), hash);
+    return static_cast<size_t>(fnv1a(spelling.file, hash));
+}
+
+bool TextureCache::SpellingEqual::operator()(const Spelling& lhs, const Spelling& rhs) const
+{
+    return lhs.flags == rhs.flags && lhs.directory == rhs.directory && lhs.file == rhs.file;
+}
+
+const std::string& TextureCache::getKey(const Spelling& spelling)
+{
+    auto it = m_keys.find(spelling);
+
+    if (it != m_keys.end())
+    {
+        return it->second;
+    }
+
+    // Resolving touches the file system, so every spelling is resolved once.
+    const std::string path = joinPath(spelling.directory, spelling.file);
+
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(std::filesystem::path(path), error);
+
+    if (error)
+    {
+        canonical = std::filesystem::path(path).lexically_normal();
+    }
+
+    std::string key = canonical.string();
+    key += (spelling.flags & 1u) ? "#flip" : "#noflip";
+    key += (spelling.flags & 2u) ? "#srgb" : "#linear";
+    key += (spelling.flags & 4u) ? "#streamed" : "";
+
+    StoredSpelling stored { std::string(spelling.directory), std::string(spelling.file), spelling.flags };
+
+    return m_keys.emplace(std::move(stored), std::move(key)).first->second;
+}
\ No newline at end of file
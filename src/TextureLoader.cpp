@@ -0,0 +1,275 @@
+#include "TextureLoader.hpp"
+
+#include "Logger.hpp"
+#include "Profiler.hpp"
+#include "TextureStreamer.hpp"
+
+#include <stb/stb_image.h>
+
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+
+namespace
+{
+    constexpr size_t DECODED_QUEUE_CAPACITY = 8;
+
+    std::optional<Ktx2Image> loadCompressed(const TextureLoader::Request& request)
+    {
+        const std::string path = Texture::getCompressedPath(request.path);
+        std::error_code error;
+
+        if (!request.allowCompressed || !std::filesystem::exists(path, error))
+        {
+            return std::nullopt;
+        }
+
+        std::optional<Ktx2Image> image = readKtx2(path);
+
+        if (image && image->flippedVertically != request.params.flipVertically)
+        {
+            logWarning("Ignoring {}: orientation does not match", path);
+            return std::nullopt;
+        }
+
+        return image;
+    }
+}
+
+
+TextureLoader& TextureLoader::get()
+{
+    static TextureLoader loader(std::max(2u, std::thread::hardware_concurrency()) - 1, DECODED_QUEUE_CAPACITY);
+    return loader;
+}
+
+TextureLoader::TextureLoader(size_t workerCount, size_t queueCapacity) : m_capacity(queueCapacity)
+{
+    m_workers.reserve(workerCount);
+
+    for (size_t idx = 0; idx < workerCount; ++idx)
+    {
+        m_workers.emplace_back(&TextureLoader::work, this);
+    }
+}
+
+TextureLoader::~TextureLoader()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_requestAvailable.notify_all();
+    m_spaceAvailable.notify_all();
+
+    for (std::thread& worker : m_workers)
+    {
+        worker.join();
+    }
+}
+
+void TextureLoader::submit(std::vector<Request>&& requests)
+{
+    if (requests.empty())
+    {
+        return;
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        m_pending += requests.size();
+        m_requests.insert(m_requests.end(), std::make_move_iterator(requests.begin()), std::make_move_iterator(requests.end()));
+    }
+
+    requests.clear();
+    m_requestAvailable.notify_all();
+}
+
+size_t TextureLoader::upload(std::chrono::microseconds budget)
+{
+    const auto start = std::chrono::steady_clock::now();
+    size_t uploaded = 0;
+
+    while (std::chrono::steady_clock::now() - start < budget && uploadNext())
+    {
+        ++uploaded;
+    }
+
+    return uploaded;
+}
+
+void TextureLoader::finish()
+{
+    for (;;)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_decodedAvailable.wait(lock, [this] { return m_pending == 0 || !m_decoded.empty(); });
+
+            if (m_pending == 0)
+            {
+                return;
+            }
+        }
+
+        while (uploadNext())
+        {
+        }
+    }
+}
+
+size_t TextureLoader::getPendingCount() const
+{
+    std::lock_guard lock(m_mutex);
+    return m_pending;
+}
+
+bool TextureLoader::uploadNext()
+{
+    Decoded decoded;
+
+    {
+        std::lock_guard lock(m_mutex);
+
+        if (m_decoded.empty())
+        {
+            return false;
+        }
+
+        decoded = std::move(m_decoded.front());
+        m_decoded.pop_front();
+        --m_pending;
+    }
+
+    m_spaceAvailable.notify_one();
+
+    ProfileZone zone("TextureLoader::uploadNext");
+
+    const std::shared_ptr<TextureResource> texture = decoded.request.texture.lock();
+
+    if (texture && decoded.compressed)
+    {
+        const uint32_t format = Texture::getCompressedFormat(decoded.compressed->format);
+
+        if (format == 0)
+        {
+            logWarning("Unsupported compressed format {}, decoding: {}", static_cast<uint32_t>(decoded.compressed->format), decoded.request.path);
+
+            decoded.request.allowCompressed = false;
+
+            {
+                std::lock_guard lock(m_mutex);
+
+                ++m_pending;
+                m_requests.push_back(std::move(decoded.request));
+            }
+
+            m_requestAvailable.notify_one();
+
+            return true;
+        }
+
+        Texture::uploadCompressed(*texture, *decoded.compressed, format);
+    }
+    else if (texture && decoded.mips.levels.empty())
+    {
+        TextureStreamer::get().cancelPageIn(*texture);
+    }
+    else if (texture)
+    {
+        const TextureLoader::Request& request = decoded.request;
+        uint32_t firstLevel = request.firstLevel.value_or(0);
+
+        if (!request.firstLevel && request.params.streamed)
+        {
+            firstLevel = TextureStreamer::get().registerTexture(texture, request, decoded.mips);
+        }
+
+        Texture::upload(*texture, decoded.mips, firstLevel);
+    }
+
+    return true;
+}
+
+void TextureLoader::work()
+{
+    Profiler::get().setThreadName("TextureLoader");
+
+    for (;;)
+    {
+        Request request;
+
+        {
+            std::unique_lock lock(m_mutex);
+            m_requestAvailable.wait(lock, [this] { return m_stopping || !m_requests.empty(); });
+
+            if (m_stopping)
+            {
+                return;
+            }
+
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+        }
+
+        Decoded decoded { std::move(request), {}, std::nullopt };
+        bool loaded = false;
+
+        {
+            ProfileZone zone("TextureLoader::loadCompressed");
+
+            decoded.compressed = loadCompressed(decoded.request);
+            loaded = decoded.compressed.has_value();
+        }
+
+        if (!loaded)
+        {
+            ProfileZone zone("TextureLoader::decode");
+
+            int32_t width, height, channels;
+
+            stbi_set_flip_vertically_on_load_thread(decoded.request.params.flipVertically);
+            uint8_t* pixels = stbi_load(decoded.request.path.c_str(), &width, &height, &channels, 0);
+
+            if (pixels != nullptr)
+            {
+                decoded.mips = buildMipChain(pixels, width, height, channels, decoded.request.params.srgb);
+                stbi_image_free(pixels);
+                loaded = true;
+            }
+        }
+
+        std::unique_lock lock(m_mutex);
+
+        if (!loaded)
+        {
+            logError("Failed to load texture: {}", decoded.request.path);
+
+            // Failed page-ins still go to the GL thread, which tells the
+            // streamer to stop waiting for them.
+            if (!decoded.request.firstLevel)
+            {
+                --m_pending;
+                lock.unlock();
+                m_decodedAvailable.notify_all();
+
+                continue;
+            }
+        }
+
+        m_spaceAvailable.wait(lock, [this] { return m_stopping || m_decoded.size() < m_capacity; });
+
+        if (m_stopping)
+        {
+            return;
+        }
+
+        m_decoded.push_back(std::move(decoded));
+        lock.unlock();
+
+        m_decodedAvailable.notify_all();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,228 @@
+#include "TextureStreamer.hpp"
+
+#include "Logger.hpp"
+
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr uint32_t TAIL_SIZE = 256;
+    constexpr size_t DEFAULT_BUDGET = 256ull << 20;
+    constexpr uint32_t NO_LEVEL = std::numeric_limits<uint32_t>::max();
+}
+
+
+TextureStreamer& TextureStreamer::get()
+{
+    static TextureStreamer streamer;
+    return streamer;
+}
+
+TextureStreamer::TextureStreamer() : m_budget(DEFAULT_BUDGET) {}
+
+void TextureStreamer::setBudget(size_t bytes)
+{
+    m_budget = bytes;
+}
+
+uint32_t TextureStreamer::registerTexture(const std::shared_ptr<TextureResource>& texture, const TextureLoader::Request& request, const MipChain& mips)
+{
+    uint32_t tailLevel = 0;
+
+    while (tailLevel + 1 < mips.levels.size() && std::max(mips.levels[tailLevel].width, mips.levels[tailLevel].height) > TAIL_SIZE)
+    {
+        ++tailLevel;
+    }
+
+    if (tailLevel == 0)
+    {
+        return 0;
+    }
+
+    Entry entry { texture, request.path, request.params, sliceMipChain(mips, tailLevel), tailLevel, mips.levels, mips.data.size(), tailLevel, NO_LEVEL, m_frame, false };
+    m_entries.insert_or_assign(texture.get(), std::move(entry));
+
+    return tailLevel;
+}
+
+void TextureStreamer::request(const std::shared_ptr<TextureResource>& texture, float pixels)
+{
+    auto it = m_entries.find(texture.get());
+
+    if (it == m_entries.end() || it->second.texture.expired())
+    {
+        return;
+    }
+
+    Entry& entry = it->second;
+
+    // The level whose width matches the on-screen size; finer ones would only
+    // be minified away.
+    const float size = static_cast<float>(std::max(entry.levels[0].width, entry.levels[0].height));
+    const float level = pixels > 0.0f ? std::floor(std::log2(size / pixels)) : static_cast<float>(entry.tailLevel);
+    const uint32_t wanted = static_cast<uint32_t>(std::clamp(level, 0.0f, static_cast<float>(entry.tailLevel)));
+
+    if (entry.lastUsedFrame != m_frame)
+    {
+        entry.wantedLevel = wanted;
+        entry.lastUsedFrame = m_frame;
+    }
+    else
+    {
+        entry.wantedLevel = std::min(entry.wantedLevel, wanted);
+    }
+}
+
+void TextureStreamer::cancelPageIn(const TextureResource& texture)
+{
+    auto it = m_entries.find(&texture);
+
+    if (it == m_entries.end() || it->second.loadingLevel == NO_LEVEL)
+    {
+        return;
+    }
+
+    logWarning("Page-in failed, streaming stopped: {}", it->second.path);
+
+    it->second.loadingLevel = NO_LEVEL;
+    it->second.failed = true;
+}
+
+void TextureStreamer::update()
+{
+    struct Candidate
+    {
+        Entry* entry;
+        uint32_t missingLevels;
+    };
+
+    size_t resident = 0;
+    std::vector<Candidate> candidates;
+
+    for (auto it = m_entries.begin(); it != m_entries.end();)
+    {
+        const std::shared_ptr<TextureResource> texture = it->second.texture.lock();
+
+        if (!texture)
+        {
+            it = m_entries.erase(it);
+            continue;
+        }
+
+        Entry& entry = it->second;
+
+        if (entry.loadingLevel != NO_LEVEL && texture->residentLevel <= entry.loadingLevel)
+        {
+            entry.loadingLevel = NO_LEVEL;
+        }
+
+        // Pending page-ins are counted at the size they will have.
+        resident += entry.loadingLevel != NO_LEVEL ? getResidentSize(entry, entry.loadingLevel) : texture->bytes;
+
+        if (entry.lastUsedFrame == m_frame && entry.loadingLevel == NO_LEVEL && !entry.failed && entry.wantedLevel < texture->residentLevel)
+        {
+            candidates.push_back({ &entry, texture->residentLevel - entry.wantedLevel });
+        }
+
+        ++it;
+    }
+
+    // Textures missing the most detail go first.
+    auto byMissingLevels = [](const Candidate& lhs, const Candidate& rhs) { return lhs.missingLevels > rhs.missingLevels; };
+    std::sort(candidates.begin(), candidates.end(), byMissingLevels);
+
+    for (const Candidate& candidate : candidates)
+    {
+        Entry* entry = candidate.entry;
+        const size_t current = entry->texture.lock()->bytes;
+        const size_t extra = getResidentSize(*entry, entry->wantedLevel) - current;
+
+        while (resident + extra > m_budget)
+        {
+            Entry* victim = findEvictionCandidate();
+
+            if (victim == nullptr)
+            {
+                break;
+            }
+
+            resident -= evict(*victim);
+        }
+
+        if (resident + extra > m_budget)
+        {
+            continue;
+        }
+
+        m_requests.push_back({ entry->texture, entry->path, entry->params, false, entry->wantedLevel });
+
+        entry->loadingLevel = entry->wantedLevel;
+        resident += extra;
+        ++m_pageIns;
+    }
+
+    TextureLoader::get().submit(std::move(m_requests));
+
+    ++m_frame;
+}
+
+TextureStreamer::Stats TextureStreamer::getStats() const
+{
+    Stats stats;
+    stats.pageIns = m_pageIns;
+    stats.evictions = m_evictions;
+
+    for (const auto& [key, entry] : m_entries)
+    {
+        if (const std::shared_ptr<TextureResource> texture = entry.texture.lock())
+        {
+            ++stats.streamedCount;
+            stats.residentBytes += texture->bytes;
+        }
+    }
+
+    return stats;
+}
+
+size_t TextureStreamer::getResidentSize(const Entry& entry, uint32_t level)
+{
+    return entry.size - entry.levels[level].offset;
+}
+
+TextureStreamer::Entry* TextureStreamer::findEvictionCandidate()
+{
+    Entry* candidate = nullptr;
+
+    for (auto& [key, entry] : m_entries)
+    {
+        const std::shared_ptr<TextureResource> texture = entry.texture.lock();
+
+        if (!texture || entry.lastUsedFrame == m_frame || entry.loadingLevel != NO_LEVEL || texture->residentLevel >= entry.tailLevel)
+        {
+            continue;
+        }
+
+        if (candidate == nullptr || entry.lastUsedFrame < candidate->lastUsedFrame)
+        {
+            candidate = &entry;
+        }
+    }
+
+    return candidate;
+}
+
+size_t TextureStreamer::evict(Entry& entry)
+{
+    const std::shared_ptr<TextureResource> texture = entry.texture.lock();
+    const size_t before = texture->bytes;
+
+    Texture::upload(*texture, entry.tail);
+    texture->residentLevel = entry.tailLevel;
+
+    ++m_evictions;
+
+    return before - texture->bytes;
+}
\ No newline at end of file
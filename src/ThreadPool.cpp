@@ -0,0 +1,161 @@
+#include "ThreadPool.hpp"
+
+#include <optional>
+#include <algorithm>
+
+
+namespace
+{
+    // Chunks per worker: enough slack for stealing to even out uneven work.
+    constexpr size_t CHUNKS_PER_WORKER = 4;
+}
+
+
+ThreadPool& ThreadPool::get()
+{
+    static ThreadPool pool(std::max(2u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+}
+
+ThreadPool::ThreadPool(size_t threadCount)
+{
+    // One queue per thread plus one for the caller of parallelFor.
+    for (size_t idx = 0; idx < threadCount + 1; ++idx)
+    {
+        m_queues.push_back(std::make_unique<Queue>());
+    }
+
+    m_threads.reserve(threadCount);
+
+    for (size_t idx = 0; idx < threadCount; ++idx)
+    {
+        m_threads.emplace_back(&ThreadPool::work, this, idx);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard lock(m_mutex);
+        m_stopping = true;
+    }
+
+    m_chunksAvailable.notify_all();
+
+    for (std::thread& thread : m_threads)
+    {
+        thread.join();
+    }
+}
+
+size_t ThreadPool::getWorkerCount() const
+{
+    return m_queues.size();
+}
+
+void ThreadPool::parallelFor(size_t count, const Body& body)
+{
+    if (count == 0)
+    {
+        return;
+    }
+
+    std::lock_guard callerLock(m_callerMutex);
+
+    const size_t workerCount = getWorkerCount();
+    const size_t callerWorker = workerCount - 1;
+    const size_t chunkSize = std::max<size_t>(1, count / (workerCount * CHUNKS_PER_WORKER));
+    const size_t chunkCount = (count + chunkSize - 1) / chunkSize;
+
+    Job job { &body, chunkCount };
+
+    for (size_t chunk = 0; chunk < chunkCount; ++chunk)
+    {
+        Queue& queue = *m_queues[chunk % workerCount];
+        std::lock_guard lock(queue.mutex);
+
+        queue.chunks.push_back({ &job, chunk * chunkSize, std::min(count, (chunk + 1) * chunkSize) });
+    }
+
+    {
+        std::lock_guard lock(m_mutex);
+        m_queuedChunks += chunkCount;
+    }
+
+    m_chunksAvailable.notify_all();
+
+    while (job.remaining.load(std::memory_order_acquire) > 0)
+    {
+        // Help out; once nothing is left to steal, the remaining chunks are
+        // already running on the workers.
+        if (!runChunk(callerWorker))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+bool ThreadPool::runChunk(size_t worker)
+{
+    std::optional<Chunk> chunk;
+
+    for (size_t offset = 0; offset < m_queues.size() && !chunk; ++offset)
+    {
+        Queue& queue = *m_queues[(worker + offset) % m_queues.size()];
+        std::lock_guard lock(queue.mutex);
+
+        if (queue.chunks.empty())
+        {
+            continue;
+        }
+
+        // Own work from the back (most recently queued), stolen work from the
+        // front.
+        if (offset == 0)
+        {
+            chunk = queue.chunks.back();
+            queue.chunks.pop_back();
+        }
+        else
+        {
+            chunk = queue.chunks.front();
+            queue.chunks.pop_front();
+        }
+    }
+
+    if (!chunk)
+    {
+        return false;
+    }
+
+    --m_queuedChunks;
+
+    for (size_t index = chunk->begin; index < chunk->end; ++index)
+    {
+        (*chunk->job->body)(index, worker);
+    }
+
+    chunk->job->remaining.fetch_sub(1, std::memory_order_release);
+
+    return true;
+}
+
+void ThreadPool::work(size_t worker)
+{
+    while (true)
+    {
+        {
+            std::unique_lock lock(m_mutex);
+            m_chunksAvailable.wait(lock, [this] { return m_stopping || m_queuedChunks > 0; });
+
+            if (m_stopping)
+            {
+                return;
+            }
+        }
+
+        while (runChunk(worker))
+        {
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#include "UniformRing.hpp"
+
+#include "Logger.hpp"
+#include "GLState.hpp"
+
+#include <cstring>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr GLuint64 FENCE_TIMEOUT = 1'000'000'000;
+
+    bool hasBufferStorage()
+    {
+        return GLEW_VERSION_4_4 || GLEW_ARB_buffer_storage;
+    }
+
+    size_t alignUp(size_t value, size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    void releaseBuffer(uint32_t buffer, bool mapped)
+    {
+        GLState::forgetUniformBuffer(buffer);
+
+        if (mapped)
+        {
+            glBindBuffer(GL_UNIFORM_BUFFER, buffer);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+
+        glDeleteBuffers(1, &buffer);
+    }
+}
+
+
+UniformRing UniformRing::create(size_t frameSize)
+{
+    UniformRing self;
+
+    GLint alignment = 0;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+
+    self.m_alignment = alignment > 0 ? static_cast<size_t>(alignment) : 256;
+    self.allocate(frameSize);
+
+    return self;
+}
+
+UniformRing::~UniformRing()
+{
+    for (GLsync fence : m_fences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+        }
+    }
+
+    for (const RetiredBuffer& retired : m_retiredBuffers)
+    {
+        releaseBuffer(retired.buffer, retired.mapped);
+    }
+
+    if (m_buffer != 0)
+    {
+        releaseBuffer(m_buffer, m_mapped != nullptr);
+    }
+}
+
+UniformRing::UniformRing(UniformRing&& other) noexcept
+{
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_mapped, other.m_mapped);
+    std::swap(m_frameSize, other.m_frameSize);
+    std::swap(m_alignment, other.m_alignment);
+    std::swap(m_frame, other.m_frame);
+    std::swap(m_offset, other.m_offset);
+    std::swap(m_end, other.m_end);
+    std::swap(m_fences, other.m_fences);
+    std::swap(m_retiredBuffers, other.m_retiredBuffers);
+}
+
+UniformRing& UniformRing::operator=(UniformRing&& other) noexcept
+{
+    std::swap(m_buffer, other.m_buffer);
+    std::swap(m_mapped, other.m_mapped);
+    std::swap(m_frameSize, other.m_frameSize);
+    std::swap(m_alignment, other.m_alignment);
+    std::swap(m_frame, other.m_frame);
+    std::swap(m_offset, other.m_offset);
+    std::swap(m_end, other.m_end);
+    std::swap(m_fences, other.m_fences);
+    std::swap(m_retiredBuffers, other.m_retiredBuffers);
+
+    return *this;
+}
+
+void UniformRing::beginFrame()
+{
+    const uint32_t region = m_frame % FRAME_COUNT;
+    GLsync& fence = m_fences[region];
+
+    if (fence != nullptr)
+    {
+        GLenum status = glClientWaitSync(fence, 0, 0);
+
+        while (status == GL_TIMEOUT_EXPIRED)
+        {
+            status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, FENCE_TIMEOUT);
+        }
+
+        if (status == GL_WAIT_FAILED)
+        {
+            logLimited<LogLevel::Warning>("Waiting for the uniform ring fence failed");
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+
+    m_offset = region * m_frameSize;
+    m_end = m_offset + m_frameSize;
+}
+
+void UniformRing::endFrame()
+{
+    m_fences[m_frame % FRAME_COUNT] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    ++m_frame;
+
+    // Every draw using a replaced buffer has been issued by now. GL defers
+    // the deletion until the GPU is done with them, and the next frame binds
+    // its blocks from the new buffer.
+    for (const RetiredBuffer& retired : m_retiredBuffers)
+    {
+        releaseBuffer(retired.buffer, retired.mapped);
+    }
+
+    m_retiredBuffers.clear();
+}
+
+UniformRing::Slice UniformRing::push(const void* data, size_t size)
+{
+    if (m_offset + size > m_end)
+    {
+        // Blocks pushed earlier in this frame are still referenced by issued
+        // draws, so they must not be overwritten. Move on to a larger buffer
+        // instead; the old one stays alive until the end of the frame.
+        const size_t frameSize = std::max(2 * m_frameSize, size);
+
+        logWarning("Uniform ring frame of {} bytes overflowed, growing to {} bytes", m_frameSize, alignUp(frameSize, m_alignment));
+
+        m_retiredBuffers.push_back({ m_buffer, m_mapped != nullptr });
+        allocate(frameSize);
+    }
+
+    const Slice slice { m_buffer, static_cast<uint32_t>(m_offset), static_cast<uint32_t>(size) };
+
+    if (m_mapped != nullptr)
+    {
+        std::memcpy(m_mapped + m_offset, data, size);
+    }
+    else
+    {
+        glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+        glBufferSubData(GL_UNIFORM_BUFFER, static_cast<GLintptr>(m_offset), static_cast<GLsizeiptr>(size), data);
+    }
+
+    m_offset = alignUp(m_offset + size, m_alignment);
+
+    return slice;
+}
+
+void UniformRing::bind(UniformBinding binding, Slice slice) const
+{
+    GLState::bindUniformBuffer(static_cast<uint32_t>(binding), slice.buffer, slice.offset, slice.size);
+}
+
+bool UniformRing::isPersistent() const
+{
+    return m_mapped != nullptr;
+}
+
+void UniformRing::allocate(size_t frameSize)
+{
+    m_frameSize = alignUp(frameSize, m_alignment);
+    m_mapped = nullptr;
+
+    const GLsizeiptr totalSize = static_cast<GLsizeiptr>(m_frameSize * FRAME_COUNT);
+
+    glGenBuffers(1, &m_buffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+
+    if (hasBufferStorage())
+    {
+        constexpr GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+        glBufferStorage(GL_UNIFORM_BUFFER, totalSize, nullptr, flags);
+        m_mapped = static_cast<uint8_t*>(glMapBufferRange(GL_UNIFORM_BUFFER, 0, totalSize, flags));
+
+        if (m_mapped == nullptr)
+        {
+            logWarning("Failed to map uniform ring, falling back to glBufferSubData");
+
+            // Immutable storage cannot be respecified, so start over with a
+            // fresh buffer.
+            glDeleteBuffers(1, &m_buffer);
+            glGenBuffers(1, &m_buffer);
+            glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+            glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+        }
+    }
+    else
+    {
+        glBufferData(GL_UNIFORM_BUFFER, totalSize, nullptr, GL_STREAM_DRAW);
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    // The fences guard regions of the previous buffer, which is never
+    // written again, so they need no waiting.
+    for (GLsync& fence : m_fences)
+    {
+        if (fence != nullptr)
+        {
+            glDeleteSync(fence);
+            fence = nullptr;
+        }
+    }
+
+    const uint32_t region = m_frame % FRAME_COUNT;
+
+    m_offset = region * m_frameSize;
+    m_end = m_offset + m_frameSize;
+}
\ No newline at end of file
@@ -0,0 +1,112 @@
+#include "VertexFormat.hpp"
+
+#include <glm/gtc/packing.hpp>
+
+#include <cmath>
+#include <algorithm>
+
+
+namespace
+{
+    constexpr float UNORM16_MAX = 65535.0f;
+    constexpr float SNORM16_MAX = 32767.0f;
+
+    float signNotZero(float value)
+    {
+        return value >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    glm::vec2 encodeOctahedral(const glm::vec3& normal)
+    {
+        const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+
+        if (length == 0.0f)
+        {
+            return glm::vec2(0.0f);
+        }
+
+        glm::vec2 encoded = glm::vec2(normal.x, normal.y) / length;
+
+        if (normal.z < 0.0f)
+        {
+            encoded = glm::vec2((1.0f - std::abs(encoded.y)) * signNotZero(encoded.x), (1.0f - std::abs(encoded.x)) * signNotZero(encoded.y));
+        }
+
+        return encoded;
+    }
+
+    glm::vec3 decodeOctahedral(const glm::vec2& encoded)
+    {
+        glm::vec3 normal(encoded.x, encoded.y, 1.0f - std::abs(encoded.x) - std::abs(encoded.y));
+
+        if (normal.z < 0.0f)
+        {
+            normal.x = (1.0f - std::abs(encoded.y)) * signNotZero(encoded.x);
+            normal.y = (1.0f - std::abs(encoded.x)) * signNotZero(encoded.y);
+        }
+
+        const float length = glm::length(normal);
+
+        return length > 0.0f ? normal / length : normal;
+    }
+
+    uint16_t packUnorm16(float value)
+    {
+        return static_cast<uint16_t>(std::lround(std::clamp(value, 0.0f, 1.0f) * UNORM16_MAX));
+    }
+
+    int16_t packSnorm16(float value)
+    {
+        return static_cast<int16_t>(std::lround(std::clamp(value, -1.0f, 1.0f) * SNORM16_MAX));
+    }
+}
+
+
+VertexQuantization VertexQuantization::fromBounds(const AABB& bounds)
+{
+    if (bounds.isEmpty())
+    {
+        return VertexQuantization {};
+    }
+
+    // Flat boxes still need a non-zero scale to divide by.
+    return VertexQuantization { bounds.min, glm::max(bounds.max - bounds.min, glm::vec3(1e-6f)) };
+}
+
+size_t getVertexStride(VertexFormat format)
+{
+    return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+}
+
+PackedVertex packVertex(const Vertex& vertex, const VertexQuantization& quantization)
+{
+    const glm::vec3 position = (vertex.position - quantization.offset) / quantization.scale;
+    const glm::vec2 normal = encodeOctahedral(vertex.normal);
+
+    PackedVertex packed;
+
+    packed.position[0] = packUnorm16(position.x);
+    packed.position[1] = packUnorm16(position.y);
+    packed.position[2] = packUnorm16(position.z);
+    packed.padding = 0;
+    packed.normal[0] = packSnorm16(normal.x);
+    packed.normal[1] = packSnorm16(normal.y);
+    packed.texCoords[0] = glm::packHalf1x16(vertex.texCoords.x);
+    packed.texCoords[1] = glm::packHalf1x16(vertex.texCoords.y);
+
+    return packed;
+}
+
+Vertex unpackVertex(const PackedVertex& vertex, const VertexQuantization& quantization)
+{
+    const glm::vec3 position(vertex.position[0] / UNORM16_MAX, vertex.position[1] / UNORM16_MAX, vertex.position[2] / UNORM16_MAX);
+    const glm::vec2 normal(std::max(vertex.normal[0] / SNORM16_MAX, -1.0f), std::max(vertex.normal[1] / SNORM16_MAX, -1.0f));
+
+    Vertex unpacked;
+
+    unpacked.position = quantization.offset + position * quantization.scale;
+    unpacked.normal = decodeOctahedral(normal);
+    unpacked.texCoords = glm::vec2(glm::unpackHalf1x16(vertex.texCoords[0]), glm::unpackHalf1x16(vertex.texCoords[1]));
+
+    return unpacked;
+}
\ No newline at end of file
@@ -0,0 +1,215 @@
+// Compares mip chain generation by the driver (glTexImage2D + glGenerateMipmap)
+// against buildMipChain() on the CPU followed by an immutable-storage upload.
+//
+// Usage: MipmapBenchmark [--size N] [--textures N] [--iterations N]
+//
+// Each case uploads a batch of synthetic RGBA textures and waits for the GPU
+// with glFinish(); the median batch time over all iterations is reported.
+// The "parallel" case builds the batch's chains on the thread pool, as the
+// texture loader does across its workers.
+
+#include "Logger.hpp"
+#include "MipChain.hpp"
+#include "ThreadPool.hpp"
+
+#include <GL/glew.h>
+#include <GLFW/glfw3.h>
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+#include <algorithm>
+#include <functional>
+
+
+namespace
+{
+    struct Options
+    {
+        uint32_t size = 2048;
+        uint32_t textureCount = 8;
+        uint32_t iterations = 5;
+    };
+
+    std::vector<uint8_t> createImage(uint32_t size, uint32_t seed)
+    {
+        std::vector<uint8_t> pixels(static_cast<size_t>(size) * size * 4);
+        uint32_t state = seed * 747796405u + 2891336453u;
+
+        for (uint32_t y = 0; y < size; ++y)
+        {
+            for (uint32_t x = 0; x < size; ++x)
+            {
+                state = state * 1664525u + 1013904223u;
+
+                uint8_t* texel = &pixels[(static_cast<size_t>(y) * size + x) * 4];
+                texel[0] = static_cast<uint8_t>(x * 255 / size);
+                texel[1] = static_cast<uint8_t>(y * 255 / size);
+                texel[2] = static_cast<uint8_t>(state >> 24);
+                texel[3] = 255;
+            }
+        }
+
+        return pixels;
+    }
+
+    void uploadChain(uint32_t texture, const MipChain& mips)
+    {
+        glBindTexture(GL_TEXTURE_2D, texture);
+        glTexStorage2D(GL_TEXTURE_2D, static_cast<int32_t>(mips.levels.size()), GL_RGBA8, mips.width, mips.height);
+
+        for (size_t level = 0; level < mips.levels.size(); ++level)
+        {
+            const MipChain::Level& data = mips.levels[level];
+            glTexSubImage2D(GL_TEXTURE_2D, static_cast<int32_t>(level), 0, 0, data.width, data.height, GL_RGBA, GL_UNSIGNED_BYTE, mips.data.data() + data.offset);
+        }
+    }
+
+    // Runs one batch per iteration on fresh texture names and returns the
+    // median time in milliseconds.
+    double measure(const Options& options, const std::function<void(const std::vector<uint32_t>&)>& batch)
+    {
+        std::vector<double> times;
+        std::vector<uint32_t> textures(options.textureCount);
+
+        for (uint32_t iteration = 0; iteration < options.iterations; ++iteration)
+        {
+            glGenTextures(static_cast<int32_t>(textures.size()), textures.data());
+            glFinish();
+
+            const auto start = std::chrono::steady_clock::now();
+
+            batch(textures);
+            glFinish();
+
+            times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            glDeleteTextures(static_cast<int32_t>(textures.size()), textures.data());
+        }
+
+        std::sort(times.begin(), times.end());
+        return times[times.size() / 2];
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    Logger::get()->setBlocking(true);
+
+    Options options;
+
+    for (int idx = 1; idx + 1 < argc; idx += 2)
+    {
+        const std::string_view arg = argv[idx];
+        const uint32_t value = static_cast<uint32_t>(std::max(1l, std::strtol(argv[idx + 1], nullptr, 10)));
+
+        if (arg == "--size")
+        {
+            options.size = value;
+        }
+        else if (arg == "--textures")
+        {
+            options.textureCount = value;
+        }
+        else if (arg == "--iterations")
+        {
+            options.iterations = value;
+        }
+    }
+
+    if (!glfwInit())
+    {
+        return -1;
+    }
+
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 4);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+
+    GLFWwindow* window = glfwCreateWindow(64, 64, "MipmapBenchmark", nullptr, nullptr);
+
+    if (window == nullptr)
+    {
+        glfwTerminate();
+        return -1;
+    }
+
+    glfwMakeContextCurrent(window);
+
+    if (glewInit() != GLEW_OK || !(GLEW_VERSION_4_2 || GLEW_ARB_texture_storage))
+    {
+        logError("Immutable texture storage is not available");
+        glfwTerminate();
+        return -1;
+    }
+
+    logInfo("{} / {}", reinterpret_cast<const char*>(glGetString(GL_VENDOR)), reinterpret_cast<const char*>(glGetString(GL_RENDERER)));
+    logInfo("{} textures of {}x{}, median of {} runs", options.textureCount, options.size, options.size, options.iterations);
+
+    std::vector<std::vector<uint8_t>> images;
+
+    for (uint32_t idx = 0; idx < options.textureCount; ++idx)
+    {
+        images.push_back(createImage(options.size, idx));
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    const double driver = measure(options, [&](const std::vector<uint32_t>& textures)
+    {
+        for (size_t idx = 0; idx < textures.size(); ++idx)
+        {
+            glBindTexture(GL_TEXTURE_2D, textures[idx]);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, options.size, options.size, 0, GL_RGBA, GL_UNSIGNED_BYTE, images[idx].data());
+            glGenerateMipmap(GL_TEXTURE_2D);
+        }
+    });
+
+    auto serial = [&](bool srgb, bool vectorized)
+    {
+        return measure(options, [&](const std::vector<uint32_t>& textures)
+        {
+            for (size_t idx = 0; idx < textures.size(); ++idx)
+            {
+                uploadChain(textures[idx], buildMipChain(images[idx].data(), options.size, options.size, 4, srgb, vectorized));
+            }
+        });
+    };
+
+    auto parallel = [&](bool srgb)
+    {
+        return measure(options, [&](const std::vector<uint32_t>& textures)
+        {
+            std::vector<MipChain> chains(textures.size());
+
+            ThreadPool::get().parallelFor(chains.size(), [&](size_t index, size_t)
+            {
+                chains[index] = buildMipChain(images[index].data(), options.size, options.size, 4, srgb);
+            });
+
+            for (size_t idx = 0; idx < textures.size(); ++idx)
+            {
+                uploadChain(textures[idx], chains[idx]);
+            }
+        });
+    };
+
+    auto report = [](std::string_view name, double milliseconds)
+    {
+        logInfo("{:<32} {:8.2f} ms", name, milliseconds);
+    };
+
+    report("driver glGenerateMipmap", driver);
+    report("cpu scalar", serial(false, false));
+    report("cpu sse2", serial(false, true));
+    report("cpu sse2, parallel", parallel(false));
+    report("cpu gamma-correct", serial(true, true));
+    report("cpu gamma-correct, parallel", parallel(true));
+
+    glfwTerminate();
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,472 @@
+// Offline converter from the source images (PNG/JPEG/...) to block-compressed
+// KTX2 files with a full mip chain, written next to each source as
+// "<name>.ktx2". Opaque images become BC1, images with alpha BC3.
+//
+// Usage: TextureCompressor [--force] [--no-flip] <file or directory>...
+//
+// Images are flipped vertically by default to match the orientation the
+// runtime loads textures in; the KTX2 file records it (KTXorientation).
+
+#include "Ktx2.hpp"
+#include "Logger.hpp"
+#include "ThreadPool.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb/stb_image.h>
+
+#include <array>
+#include <atomic>
+#include <string>
+#include <vector>
+#include <cctype>
+#include <cstring>
+#include <algorithm>
+#include <filesystem>
+#include <system_error>
+
+
+namespace
+{
+    constexpr std::string_view SOURCE_EXTENSIONS[] = { ".png", ".jpg", ".jpeg", ".tga", ".bmp" };
+
+    using Rgba = std::array<uint8_t, 4>;
+    using Block = std::array<Rgba, 16>;
+
+    struct Options
+    {
+        bool force = false;
+        bool flipVertically = true;
+    };
+
+    struct Image
+    {
+        uint32_t width;
+        uint32_t height;
+        std::vector<Rgba> pixels;
+    };
+
+    Image downsample(const Image& source)
+    {
+        Image result { std::max(1u, source.width / 2), std::max(1u, source.height / 2), {} };
+        result.pixels.resize(static_cast<size_t>(result.width) * result.height);
+
+        for (uint32_t y = 0; y < result.height; ++y)
+        {
+            const uint32_t y0 = std::min(2 * y, source.height - 1);
+            const uint32_t y1 = std::min(2 * y + 1, source.height - 1);
+
+            for (uint32_t x = 0; x < result.width; ++x)
+            {
+                const uint32_t x0 = std::min(2 * x, source.width - 1);
+                const uint32_t x1 = std::min(2 * x + 1, source.width - 1);
+
+                const Rgba& a = source.pixels[y0 * source.width + x0];
+                const Rgba& b = source.pixels[y0 * source.width + x1];
+                const Rgba& c = source.pixels[y1 * source.width + x0];
+                const Rgba& d = source.pixels[y1 * source.width + x1];
+
+                Rgba& texel = result.pixels[y * result.width + x];
+
+                for (size_t channel = 0; channel < 4; ++channel)
+                {
+                    texel[channel] = static_cast<uint8_t>((a[channel] + b[channel] + c[channel] + d[channel] + 2) / 4);
+                }
+            }
+        }
+
+        return result;
+    }
+
+    // Edge texels are repeated for blocks sticking out of the image.
+    Block fetchBlock(const Image& image, uint32_t blockX, uint32_t blockY)
+    {
+        Block block;
+
+        for (uint32_t y = 0; y < 4; ++y)
+        {
+            const uint32_t row = std::min(blockY * 4 + y, image.height - 1);
+
+            for (uint32_t x = 0; x < 4; ++x)
+            {
+                const uint32_t column = std::min(blockX * 4 + x, image.width - 1);
+                block[y * 4 + x] = image.pixels[row * image.width + column];
+            }
+        }
+
+        return block;
+    }
+
+    uint16_t packRgb565(const float color[3])
+    {
+        const uint32_t r = static_cast<uint32_t>(std::clamp(color[0], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+        const uint32_t g = static_cast<uint32_t>(std::clamp(color[1], 0.0f, 255.0f) * 63.0f / 255.0f + 0.5f);
+        const uint32_t b = static_cast<uint32_t>(std::clamp(color[2], 0.0f, 255.0f) * 31.0f / 255.0f + 0.5f);
+
+        return static_cast<uint16_t>(r << 11 | g << 5 | b);
+    }
+
+    Rgba unpackRgb565(uint16_t color)
+    {
+        const uint32_t r = color >> 11 & 31;
+        const uint32_t g = color >> 5 & 63;
+        const uint32_t b = color & 31;
+
+        return { static_cast<uint8_t>(r << 3 | r >> 2), static_cast<uint8_t>(g << 2 | g >> 4), static_cast<uint8_t>(b << 3 | b >> 2), 255 };
+    }
+
+    uint32_t colorDistance(const Rgba& a, const Rgba& b)
+    {
+        uint32_t distance = 0;
+
+        for (size_t channel = 0; channel < 3; ++channel)
+        {
+            const int32_t delta = a[channel] - b[channel];
+            distance += delta * delta;
+        }
+
+        return distance;
+    }
+
+    // Range fit: endpoints are the extremes of the texels projected onto the
+    // principal axis of their colors, inset slightly to balance the error.
+    // Always uses the four-color mode, as BC3 color blocks require.
+    void encodeColorBlock(const Block& block, uint8_t* output)
+    {
+        float mean[3] = {};
+
+        for (const Rgba& texel : block)
+        {
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                mean[channel] += texel[channel] / 16.0f;
+            }
+        }
+
+        float covariance[6] = {};
+
+        for (const Rgba& texel : block)
+        {
+            const float r = texel[0] - mean[0];
+            const float g = texel[1] - mean[1];
+            const float b = texel[2] - mean[2];
+
+            covariance[0] += r * r;
+            covariance[1] += r * g;
+            covariance[2] += r * b;
+            covariance[3] += g * g;
+            covariance[4] += g * b;
+            covariance[5] += b * b;
+        }
+
+        float axis[3] = { 1.0f, 1.0f, 1.0f };
+
+        for (int iteration = 0; iteration < 8; ++iteration)
+        {
+            const float x = covariance[0] * axis[0] + covariance[1] * axis[1] + covariance[2] * axis[2];
+            const float y = covariance[1] * axis[0] + covariance[3] * axis[1] + covariance[4] * axis[2];
+            const float z = covariance[2] * axis[0] + covariance[4] * axis[1] + covariance[5] * axis[2];
+            const float length = std::max({ std::abs(x), std::abs(y), std::abs(z) });
+
+            if (length == 0.0f)
+            {
+                break;
+            }
+
+            axis[0] = x / length;
+            axis[1] = y / length;
+            axis[2] = z / length;
+        }
+
+        float minProjection = 0.0f;
+        float maxProjection = 0.0f;
+        const float axisLength = axis[0] * axis[0] + axis[1] * axis[1] + axis[2] * axis[2];
+
+        for (const Rgba& texel : block)
+        {
+            const float projection = ((texel[0] - mean[0]) * axis[0] + (texel[1] - mean[1]) * axis[1] + (texel[2] - mean[2]) * axis[2]) / axisLength;
+
+            minProjection = std::min(minProjection, projection);
+            maxProjection = std::max(maxProjection, projection);
+        }
+
+        const float inset = (maxProjection - minProjection) / 16.0f;
+        minProjection += inset;
+        maxProjection -= inset;
+
+        float start[3];
+        float end[3];
+
+        for (size_t channel = 0; channel < 3; ++channel)
+        {
+            start[channel] = mean[channel] + axis[channel] * maxProjection;
+            end[channel] = mean[channel] + axis[channel] * minProjection;
+        }
+
+        uint16_t color0 = packRgb565(start);
+        uint16_t color1 = packRgb565(end);
+
+        if (color0 < color1)
+        {
+            std::swap(color0, color1);
+        }
+
+        uint32_t indices = 0;
+
+        if (color0 != color1)
+        {
+            const Rgba endpoint0 = unpackRgb565(color0);
+            const Rgba endpoint1 = unpackRgb565(color1);
+
+            Rgba palette[4] = { endpoint0, endpoint1, endpoint0, endpoint1 };
+
+            for (size_t channel = 0; channel < 3; ++channel)
+            {
+                palette[2][channel] = static_cast<uint8_t>((2 * endpoint0[channel] + endpoint1[channel] + 1) / 3);
+                palette[3][channel] = static_cast<uint8_t>((endpoint0[channel] + 2 * endpoint1[channel] + 1) / 3);
+            }
+
+            for (size_t idx = 0; idx < block.size(); ++idx)
+            {
+                uint32_t best = 0;
+                uint32_t bestDistance = colorDistance(block[idx], palette[0]);
+
+                for (uint32_t candidate = 1; candidate < 4; ++candidate)
+                {
+                    const uint32_t distance = colorDistance(block[idx], palette[candidate]);
+
+                    if (distance < bestDistance)
+                    {
+                        best = candidate;
+                        bestDistance = distance;
+                    }
+                }
+
+                indices |= best << (2 * idx);
+            }
+        }
+
+        std::memcpy(output, &color0, sizeof(color0));
+        std::memcpy(output + 2, &color1, sizeof(color1));
+        std::memcpy(output + 4, &indices, sizeof(indices));
+    }
+
+    // Eight-value mode between the block's alpha extremes.
+    void encodeAlphaBlock(const Block& block, uint8_t* output)
+    {
+        uint8_t alpha0 = 0;
+        uint8_t alpha1 = 255;
+
+        for (const Rgba& texel : block)
+        {
+            alpha0 = std::max(alpha0, texel[3]);
+            alpha1 = std::min(alpha1, texel[3]);
+        }
+
+        uint64_t indices = 0;
+
+        if (alpha0 != alpha1)
+        {
+            uint8_t palette[8] = { alpha0, alpha1 };
+
+            for (uint32_t idx = 1; idx < 7; ++idx)
+            {
+                palette[idx + 1] = static_cast<uint8_t>(((7 - idx) * alpha0 + idx * alpha1 + 3) / 7);
+            }
+
+            for (size_t idx = 0; idx < block.size(); ++idx)
+            {
+                uint64_t best = 0;
+                int32_t bestDistance = 256;
+
+                for (uint32_t candidate = 0; candidate < 8; ++candidate)
+                {
+                    const int32_t distance = std::abs(block[idx][3] - palette[candidate]);
+
+                    if (distance < bestDistance)
+                    {
+                        best = candidate;
+                        bestDistance = distance;
+                    }
+                }
+
+                indices |= best << (3 * idx);
+            }
+        }
+
+        output[0] = alpha0;
+        output[1] = alpha1;
+        std::memcpy(output + 2, &indices, 6);
+    }
+
+    void encodeLevel(const Image& image, CompressedFormat format, uint8_t* output)
+    {
+        const uint32_t blocksX = (image.width + 3) / 4;
+        const uint32_t blocksY = (image.height + 3) / 4;
+        const size_t blockSize = getBlockSize(format);
+
+        for (uint32_t blockY = 0; blockY < blocksY; ++blockY)
+        {
+            for (uint32_t blockX = 0; blockX < blocksX; ++blockX)
+            {
+                const Block block = fetchBlock(image, blockX, blockY);
+
+                if (format == CompressedFormat::Bc3)
+                {
+                    encodeAlphaBlock(block, output);
+                    encodeColorBlock(block, output + 8);
+                }
+                else
+                {
+                    encodeColorBlock(block, output);
+                }
+
+                output += blockSize;
+            }
+        }
+    }
+
+    bool isSourceImage(const std::filesystem::path& path)
+    {
+        std::string extension = path.extension().string();
+        std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+        return std::find(std::begin(SOURCE_EXTENSIONS), std::end(SOURCE_EXTENSIONS), extension) != std::end(SOURCE_EXTENSIONS);
+    }
+
+    bool isUpToDate(const std::filesystem::path& source, const std::filesystem::path& target)
+    {
+        std::error_code error;
+        const auto targetTime = std::filesystem::last_write_time(target, error);
+
+        return !error && targetTime >= std::filesystem::last_write_time(source, error) && !error;
+    }
+
+    bool compressImage(const std::filesystem::path& source, const Options& options)
+    {
+        const std::filesystem::path target = std::filesystem::path(source).replace_extension(".ktx2");
+
+        if (!options.force && isUpToDate(source, target))
+        {
+            return true;
+        }
+
+        int32_t width, height, channels;
+        uint8_t* data = stbi_load(source.string().c_str(), &width, &height, &channels, 4);
+
+        if (data == nullptr)
+        {
+            logError("Failed to load image: {} ({})", source.string(), stbi_failure_reason());
+            return false;
+        }
+
+        Image image { static_cast<uint32_t>(width), static_cast<uint32_t>(height), {} };
+        image.pixels.resize(static_cast<size_t>(width) * height);
+
+        for (uint32_t y = 0; y < image.height; ++y)
+        {
+            const uint32_t sourceRow = options.flipVertically ? image.height - 1 - y : y;
+            std::memcpy(&image.pixels[y * image.width], data + static_cast<size_t>(sourceRow) * width * 4, static_cast<size_t>(width) * 4);
+        }
+
+        stbi_image_free(data);
+
+        const bool hasAlpha = std::any_of(image.pixels.begin(), image.pixels.end(), [](const Rgba& texel) { return texel[3] != 255; });
+
+        Ktx2Image output;
+        output.format = hasAlpha ? CompressedFormat::Bc3 : CompressedFormat::Bc1;
+        output.width = image.width;
+        output.height = image.height;
+        output.flippedVertically = options.flipVertically;
+
+        for (;;)
+        {
+            const size_t size = getCompressedSize(output.format, image.width, image.height);
+
+            output.levels.push_back({ output.data.size(), size, image.width, image.height });
+            output.data.resize(output.data.size() + size);
+
+            encodeLevel(image, output.format, output.data.data() + output.levels.back().offset);
+
+            if (image.width == 1 && image.height == 1)
+            {
+                break;
+            }
+
+            image = downsample(image);
+        }
+
+        if (!writeKtx2(target.string(), output))
+        {
+            return false;
+        }
+
+        logInfo("{} -> {} ({}x{}, {}, {} levels, {} KiB)", source.string(), target.filename().string(), width, height,
+            hasAlpha ? "BC3" : "BC1", output.levels.size(), output.data.size() / 1024);
+
+        return true;
+    }
+
+    void collectImages(const std::filesystem::path& path, std::vector<std::filesystem::path>& images)
+    {
+        std::error_code error;
+
+        if (!std::filesystem::is_directory(path, error))
+        {
+            images.push_back(path);
+            return;
+        }
+
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(path, error))
+        {
+            if (entry.is_regular_file() && isSourceImage(entry.path()))
+            {
+                images.push_back(entry.path());
+            }
+        }
+    }
+}
+
+
+int main(int argc, char** argv)
+{
+    Logger::get()->setBlocking(true);
+
+    Options options;
+    std::vector<std::filesystem::path> images;
+
+    for (int idx = 1; idx < argc; ++idx)
+    {
+        const std::string_view arg = argv[idx];
+
+        if (arg == "--force")
+        {
+            options.force = true;
+        }
+        else if (arg == "--no-flip")
+        {
+            options.flipVertically = false;
+        }
+        else
+        {
+            collectImages(arg, images);
+        }
+    }
+
+    if (images.empty())
+    {
+        logInfo("Usage: TextureCompressor [--force] [--no-flip] <file or directory>...");
+        return 1;
+    }
+
+    std::atomic<size_t> failures = 0;
+
+    ThreadPool::get().parallelFor(images.size(), [&](size_t index, size_t)
+    {
+        if (!compressImage(images[index], options))
+        {
+            ++failures;
+        }
+    });
+
+    return failures == 0 ? 0 : 1;
+}
\ No newline at end of file